@@ -0,0 +1,249 @@
+#ifndef BENCH_HARNESS_HPP_
+#define BENCH_HARNESS_HPP_
+
+// Minimal timing harness for the benchmark suites, kept in-tree so they
+// build without fetching a benchmark library.
+//
+// Every suite takes the same flags:
+//   --json PATH         also write the results as JSON
+//   --filter TEXT       only run benchmarks whose name contains TEXT
+//   --min-time SECONDS  time per repetition (default 0.2)
+//   --repetitions N     repetitions per benchmark (default 5)
+//   --label TEXT        stored in the JSON context, e.g. the git revision
+//
+// run() calls the body once to warm up and calibrate, then times
+// repetitions batches of as many calls as fill min_time. The spread across
+// batches shows how noisy the machine is; the median is the number to
+// track. Bodies should keep their results (a count, a size) in a captured
+// variable so the compiler cannot drop the work.
+//
+// JSON layout:
+//   {"suite": ..., "context": {"label", "compiler", "build", "hardware_threads",
+//    "profiler", "min_time_s", "repetitions"},
+//    "benchmarks": [{"name", "iterations", "repetitions", "items_per_iteration",
+//      "min_ns", "median_ns", "mean_ns", "max_ns", "items_per_second",
+//      "counters": {...}}]}
+// Times are per iteration; items_per_second uses the median.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <utility>
+#include <thread>
+#include <algorithm>
+
+namespace GLOO{
+struct BenchResult {
+    std::string name;
+    double items_per_iteration = 1.0;
+    size_t iterations = 0;
+    double min_ns = 0.0;
+    double median_ns = 0.0;
+    double mean_ns = 0.0;
+    double max_ns = 0.0;
+    // Extra numbers a benchmark reports about its workload, e.g. tree nodes.
+    std::vector<std::pair<std::string, double>> counters;
+
+    double items_per_second() const {
+        return median_ns > 0.0 ? items_per_iteration * 1e9 / median_ns : 0.0;
+    };
+};
+
+class BenchHarness {
+    public:
+        explicit BenchHarness(const char* suite) : suite_(suite) {}
+
+        // False (after printing usage) on an unknown or incomplete flag.
+        bool parse_args(int argc, char** argv) {
+            for (int i = 1; i < argc; ++i) {
+                std::string arg = argv[i];
+                if (i + 1 >= argc) {
+                    return usage(argv[0]);
+                }
+                const char* value = argv[++i];
+                if (arg == "--json") {
+                    json_path_ = value;
+                } else if (arg == "--filter") {
+                    filter_ = value;
+                } else if (arg == "--min-time") {
+                    min_time_ = std::max(std::atof(value), 0.0);
+                } else if (arg == "--repetitions") {
+                    repetitions_ = std::max(std::atoi(value), 1);
+                } else if (arg == "--label") {
+                    label_ = value;
+                } else {
+                    return usage(argv[0]);
+                }
+            }
+            return true;
+        };
+
+        // Whether name passes --filter; check it before expensive setup.
+        bool enabled(const std::string& name) const {
+            return filter_.empty() || name.find(filter_) != std::string::npos;
+        };
+
+        // Times body(), which processes items units of work per call. Returns
+        // the result, valid until the next run(), so the caller can attach
+        // counters; a filtered out benchmark is not run or recorded.
+        template <typename Body>
+        BenchResult& run(const std::string& name, double items, Body body) {
+            BenchResult result;
+            result.name = name;
+            result.items_per_iteration = items;
+            if (!enabled(name)) {
+                skipped_ = result;
+                return skipped_;
+            }
+
+            auto t0 = Clock::now();
+            body();
+            double once = seconds_since(t0);
+            size_t iterations = once > 0.0 ? static_cast<size_t>(min_time_ / once) : 1000000;
+            iterations = std::max<size_t>(iterations, 1);
+
+            if (results_.empty()) {
+                std::printf("%-36s %10s %12s %12s %12s %14s\n", "benchmark", "iters", "min", "median", "max", "items/s");
+            }
+            std::vector<double> samples;
+            for (int r = 0; r < repetitions_; ++r) {
+                t0 = Clock::now();
+                for (size_t i = 0; i < iterations; ++i) {
+                    body();
+                }
+                samples.push_back(seconds_since(t0) * 1e9 / iterations);
+            }
+            std::sort(samples.begin(), samples.end());
+            result.iterations = iterations;
+            result.min_ns = samples.front();
+            result.max_ns = samples.back();
+            size_t mid = samples.size() / 2;
+            result.median_ns = samples.size() % 2 ? samples[mid] : 0.5 * (samples[mid - 1] + samples[mid]);
+            for (double sample : samples) {
+                result.mean_ns += sample / samples.size();
+            }
+
+            std::printf("%-36s %10zu %12s %12s %12s %14.4g\n", name.c_str(), iterations, format_ns(result.min_ns).c_str(),
+                        format_ns(result.median_ns).c_str(), format_ns(result.max_ns).c_str(), result.items_per_second());
+            std::fflush(stdout);
+            results_.push_back(result);
+            return results_.back();
+        };
+
+        // Writes the JSON file if --json was given. False if that failed.
+        bool finish() const {
+            if (json_path_.empty()) return true;
+            FILE* file = std::fopen(json_path_.c_str(), "w");
+            if (file == nullptr) {
+                std::fprintf(stderr, "could not write %s\n", json_path_.c_str());
+                return false;
+            }
+            std::fprintf(file, "{\n  \"suite\": %s,\n  \"context\": {\n", quote(suite_).c_str());
+            std::fprintf(file, "    \"label\": %s,\n", quote(label_).c_str());
+            std::fprintf(file, "    \"compiler\": %s,\n", quote(compiler()).c_str());
+#ifdef NDEBUG
+            std::fprintf(file, "    \"build\": \"release\",\n");
+#else
+            std::fprintf(file, "    \"build\": \"debug\",\n");
+#endif
+            std::fprintf(file, "    \"hardware_threads\": %u,\n", std::thread::hardware_concurrency());
+#ifdef BOIDS_PROFILING
+            std::fprintf(file, "    \"profiler\": true,\n");
+#else
+            std::fprintf(file, "    \"profiler\": false,\n");
+#endif
+            std::fprintf(file, "    \"min_time_s\": %g,\n    \"repetitions\": %d\n  },\n", min_time_, repetitions_);
+            std::fprintf(file, "  \"benchmarks\": [");
+            for (size_t b = 0; b < results_.size(); ++b) {
+                const BenchResult& result = results_[b];
+                std::fprintf(file, "%s\n    {\"name\": %s, \"iterations\": %zu, \"repetitions\": %d, "
+                             "\"items_per_iteration\": %.17g,\n     \"min_ns\": %.17g, \"median_ns\": %.17g, "
+                             "\"mean_ns\": %.17g, \"max_ns\": %.17g, \"items_per_second\": %.17g, \"counters\": {",
+                             b ? "," : "", quote(result.name).c_str(), result.iterations, repetitions_,
+                             result.items_per_iteration, result.min_ns, result.median_ns, result.mean_ns,
+                             result.max_ns, result.items_per_second());
+                for (size_t c = 0; c < result.counters.size(); ++c) {
+                    std::fprintf(file, "%s%s: %.17g", c ? ", " : "", quote(result.counters[c].first).c_str(),
+                                 result.counters[c].second);
+                }
+                std::fprintf(file, "}}");
+            }
+            std::fprintf(file, "\n  ]\n}\n");
+            if (std::fclose(file) != 0) {
+                std::fprintf(stderr, "could not write %s\n", json_path_.c_str());
+                return false;
+            }
+            std::printf("wrote %zu results to %s\n", results_.size(), json_path_.c_str());
+            return true;
+        };
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        static double seconds_since(Clock::time_point t0) {
+            return std::chrono::duration<double>(Clock::now() - t0).count();
+        };
+
+        static std::string format_ns(double ns) {
+            char text[32];
+            if (ns < 1e3) {
+                std::snprintf(text, sizeof(text), "%.1f ns", ns);
+            } else if (ns < 1e6) {
+                std::snprintf(text, sizeof(text), "%.2f us", ns / 1e3);
+            } else if (ns < 1e9) {
+                std::snprintf(text, sizeof(text), "%.2f ms", ns / 1e6);
+            } else {
+                std::snprintf(text, sizeof(text), "%.2f s", ns / 1e9);
+            }
+            return text;
+        };
+
+        static std::string quote(const std::string& text) {
+            std::string out = "\"";
+            for (char c : text) {
+                if (c == '"' || c == '\\') {
+                    out += '\\';
+                    out += c;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    out += escaped;
+                } else {
+                    out += c;
+                }
+            }
+            return out + "\"";
+        };
+
+        static std::string compiler() {
+#if defined(__clang__)
+            return std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+            return std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+            return "MSVC " + std::to_string(_MSC_VER);
+#else
+            return "unknown";
+#endif
+        };
+
+        bool usage(const char* argv0) const {
+            std::fprintf(stderr, "usage: %s [--json PATH] [--filter TEXT] [--min-time SECONDS]\n"
+                         "          [--repetitions N] [--label TEXT]\n", argv0);
+            return false;
+        };
+
+        std::string suite_;
+        std::string json_path_;
+        std::string filter_;
+        std::string label_;
+        double min_time_ = 0.2;
+        int repetitions_ = 5;
+        std::vector<BenchResult> results_;
+        BenchResult skipped_;
+};
+} // namespace GLOO
+
+#endif // BENCH_HARNESS_HPP_
@@ -0,0 +1,184 @@
+// Measures checkpoint size and encode/decode throughput.
+//
+// usage: bench_checkpoint [num_boids] [frames] [keyframe_interval]
+//
+// Spawns num_boids (default 250000; pass 1000000 for the run size
+// checkpoints are meant for) and checkpoints frames consecutive steps
+// (default 16) in each CheckpointMode, with a keyframe every
+// keyframe_interval frames (default 8). Prints the bytes per boid of
+// keyframes and delta frames next to the 24 of raw float32, the encode and
+// decode rates in boids per second, and the largest position and velocity
+// error. Lossless frames must decode bit for bit and quantized positions
+// and velocities to within half a quantization step; otherwise the run
+// exits with status 1.
+// Finally compares how long the simulation thread is held by a synchronous
+// encode and write against CheckpointWriter::submit().
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+
+#include "sim/FlockSimulation.hpp"
+#include "sim/Checkpoint.hpp"
+
+using namespace GLOO;
+
+namespace {
+const int kWarmupSteps = 3;
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+struct ModeResult {
+    size_t key_bytes = 0;
+    size_t key_frames = 0;
+    size_t delta_bytes = 0;
+    size_t delta_frames = 0;
+    double encode_seconds = 0.0;
+    double decode_seconds = 0.0;
+    float max_position_error = 0.f;
+    float max_velocity_error = 0.f;
+    bool ok = true;
+};
+
+// Largest difference between the boids of decoded and state, matched by id.
+void compare(const FlockState& state, const FlockState& decoded, std::vector<uint32_t>& slot_of_id,
+             float& position_error, float& velocity_error) {
+    slot_of_id.resize(state.size());
+    for (size_t i = 0; i < state.size(); ++i) {
+        slot_of_id[state.id[i]] = static_cast<uint32_t>(i);
+    }
+    for (size_t j = 0; j < decoded.size(); ++j) {
+        size_t i = slot_of_id[decoded.id[j]];
+        glm::vec3 dp = glm::abs(decoded.position(j) - state.position(i));
+        glm::vec3 dv = glm::abs(decoded.velocity(j) - state.velocity(i));
+        position_error = std::max(position_error, std::max(dp.x, std::max(dp.y, dp.z)));
+        velocity_error = std::max(velocity_error, std::max(dv.x, std::max(dv.y, dv.z)));
+        if (decoded.is_predator(j) != state.is_predator(i)) {
+            position_error = INFINITY;
+        }
+    }
+}
+
+void print(const char* name, const ModeResult& result, size_t n, int frames) {
+    double key = result.key_frames ? static_cast<double>(result.key_bytes) / result.key_frames / n : 0.0;
+    double delta = result.delta_frames ? static_cast<double>(result.delta_bytes) / result.delta_frames / n : 0.0;
+    double total = static_cast<double>(result.key_bytes + result.delta_bytes) / frames / n;
+    std::printf("%-10s %8.2f %8.2f %8.2f %12.3g %12.3g %10.2e %10.2e\n", name, key, delta, total,
+                n * frames / result.encode_seconds, n * frames / result.decode_seconds,
+                result.max_position_error, result.max_velocity_error);
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    int num_boids = argc > 1 ? std::atoi(argv[1]) : 250000;
+    int frames = argc > 2 ? std::max(std::atoi(argv[2]), 1) : 16;
+    int keyframe_interval = argc > 3 ? std::max(std::atoi(argv[3]), 1) : 8;
+
+    FlockSimulation sim;
+    sim.warn_slow_steps_ = false;
+    sim.spawn(num_boids, 5);
+    for (int i = 0; i < kWarmupSteps; ++i) {
+        sim.step();
+    }
+    size_t n = sim.size();
+
+    CheckpointEncoder encoders[2] = {
+        CheckpointEncoder(CheckpointMode::Quantized, keyframe_interval),
+        CheckpointEncoder(CheckpointMode::Lossless, keyframe_interval)
+    };
+    CheckpointDecoder decoders[2];
+    ModeResult results[2];
+    std::vector<uint8_t> buffer;
+    std::vector<uint32_t> slot_of_id;
+    Checkpoint decoded;
+    // Widest velocity range a quantized keyframe used: max_speed or the
+    // fastest component, as in CheckpointEncoder::encode_keyframe.
+    float max_speed = sim.params_[6];
+
+    for (int frame = 0; frame < frames; ++frame) {
+        sim.step();
+        const FlockState& state = sim.get_state();
+        for (size_t i = 0; i < n; ++i) {
+            glm::vec3 v = glm::abs(state.velocity(i));
+            max_speed = std::max(max_speed, std::max(v.x, std::max(v.y, v.z)));
+        }
+        for (int m = 0; m < 2; ++m) {
+            ModeResult& result = results[m];
+            buffer.clear();
+            auto t0 = std::chrono::steady_clock::now();
+            encoders[m].encode(sim.get_step_count(), state, sim.params_, sim.lower_bounds_, sim.upper_bounds_, buffer);
+            result.encode_seconds += seconds_since(t0);
+            if (encoders[m].get_last_was_keyframe()) {
+                result.key_bytes += buffer.size();
+                ++result.key_frames;
+            } else {
+                result.delta_bytes += buffer.size();
+                ++result.delta_frames;
+            }
+
+            t0 = std::chrono::steady_clock::now();
+            bool decoded_ok = decoders[m].decode(buffer.data(), buffer.size(), decoded);
+            result.decode_seconds += seconds_since(t0);
+            if (!decoded_ok || decoded.state.size() != n || decoded.step != sim.get_step_count()) {
+                result.ok = false;
+                continue;
+            }
+            compare(state, decoded.state, slot_of_id, result.max_position_error, result.max_velocity_error);
+        }
+    }
+
+    // Half a step of the widest range the quantized keyframes can use.
+    glm::vec3 extent = sim.upper_bounds_ - sim.lower_bounds_;
+    float position_tolerance = 0.f;
+    for (size_t i = 0; i < n; ++i) {
+        glm::vec3 p = glm::abs(sim.get_state().position(i));
+        extent = glm::max(extent, 2.f * p);
+    }
+    position_tolerance = 0.5f * std::max(extent.x, std::max(extent.y, extent.z)) / 65535.f * 1.01f;
+    float velocity_tolerance = 0.5f * 2.f * max_speed / 65535.f * 1.01f;
+    results[0].ok = results[0].ok && results[0].max_position_error <= position_tolerance &&
+                    results[0].max_velocity_error <= velocity_tolerance;
+    results[1].ok = results[1].ok && results[1].max_position_error == 0.f && results[1].max_velocity_error == 0.f;
+
+    std::printf("%zu boids, %d frames, keyframe every %d; raw float32 is 24 bytes/boid\n", n, frames, keyframe_interval);
+    std::printf("%-10s %8s %8s %8s %12s %12s %10s %10s\n", "mode", "key B", "delta B", "avg B",
+                "enc boids/s", "dec boids/s", "pos err", "vel err");
+    print("quantized", results[0], n, frames);
+    print("lossless", results[1], n, frames);
+
+    // Time the simulation thread spends handing one checkpoint over.
+    CheckpointEncoder sync_encoder;
+    buffer.clear();
+    auto t0 = std::chrono::steady_clock::now();
+    sync_encoder.encode(sim.get_step_count(), sim.get_state(), sim.params_, sim.lower_bounds_, sim.upper_bounds_, buffer);
+    FILE* file = std::fopen("bench_checkpoint.tmp", "wb");
+    if (file != nullptr) {
+        std::fwrite(buffer.data(), 1, buffer.size(), file);
+        std::fclose(file);
+    }
+    double sync_ms = 1000.0 * seconds_since(t0);
+
+    CheckpointWriter writer;
+    double submit_ms = 0.0;
+    if (writer.open("bench_checkpoint.tmp")) {
+        t0 = std::chrono::steady_clock::now();
+        writer.submit(sim.get_step_count(), sim.get_state(), sim.params_, sim.lower_bounds_, sim.upper_bounds_);
+        submit_ms = 1000.0 * seconds_since(t0);
+        writer.close();
+    }
+    std::remove("bench_checkpoint.tmp");
+    std::printf("simulation thread blocked per checkpoint: %.2f ms encoding and writing, %.2f ms with submit()\n",
+                sync_ms, submit_ms);
+
+    for (int m = 0; m < 2; ++m) {
+        if (!results[m].ok) {
+            std::printf("%s checkpoints did not decode to the state\n", m == 0 ? "quantized" : "lossless");
+        }
+    }
+    return results[0].ok && results[1].ok ? 0 : 1;
+}
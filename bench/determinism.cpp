@@ -0,0 +1,131 @@
+// Checks that deterministic mode gives the same flock bit for bit however
+// the simulation is run.
+//
+// usage: bench_determinism [steps] [max_threads] [golden_path]
+//
+// Runs the flock FlockNode's default constructor sets up (4000 boids and 5
+// predators, time step 0.1, spawn seed 42) for steps steps (default 200)
+// with FlockSimulation::deterministic_ set, once per spatial index, with
+// Verlet lists and with Morton reordering, each on 1 thread and on
+// max_threads threads (default: hardware concurrency, at least 4). Prints
+// hash_state() of every run; they must all agree, except that the quadtree
+// leaves out boids outside the simulation bounds and so only has to agree
+// with itself. With golden_path, the grid hash must also match the one
+// stored there; golden/determinism_grid_100.txt holds it for 100 steps, and
+// ctest runs that check. The hash is meant to hold on every platform:
+// spawn() draws from NormalSampler rather than the library's engine and
+// distribution, and flocksim is built without FMA contraction. A missing
+// or unreadable golden file is a failure, never written by the run, so
+// regenerating it is a deliberate edit. Exits with status 1 on any mismatch.
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <algorithm>
+
+#include "sim/FlockSimulation.hpp"
+#include "sim/Snapshot.hpp"
+
+using namespace GLOO;
+
+namespace {
+struct RunConfig {
+    const char* name;
+    SpatialIndexType index_type;
+    bool verlet_lists;
+    int reorder_interval;
+    // Whether the index finds the same neighbors as the grid.
+    bool exact_neighbors;
+};
+
+const RunConfig kConfigs[] = {
+    {"grid", SpatialIndexType::UniformGrid, false, 0, true},
+    {"quadtree", SpatialIndexType::QuadTree, false, 0, false},
+    {"octree", SpatialIndexType::LinearOctree, false, 0, true},
+    {"incremental", SpatialIndexType::IncrementalGrid, false, 0, true},
+    {"grid+verlet", SpatialIndexType::UniformGrid, true, 0, true},
+    {"grid+reorder", SpatialIndexType::UniformGrid, false, 10, true},
+};
+
+uint64_t run(const RunConfig& config, int steps, unsigned num_threads, double& seconds) {
+    FlockSimulation sim;
+    sim.warn_slow_steps_ = false;
+    sim.deterministic_ = true;
+    sim.index_type_ = config.index_type;
+    sim.verlet_lists_ = config.verlet_lists;
+    sim.reorder_interval_ = config.reorder_interval;
+    sim.set_time_step_size(0.1f);
+    sim.set_thread_count(num_threads);
+    sim.spawn(4000, 5);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i) {
+        sim.step();
+    }
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return hash_state(sim.get_state());
+}
+
+// Compares hash with the one in path.
+bool check_golden(const char* path, uint64_t hash) {
+    FILE* file = std::fopen(path, "r");
+    if (file == nullptr) {
+        std::printf("could not read golden hash from %s; this run's is %016" PRIx64 "\n", path, hash);
+        return false;
+    }
+    uint64_t golden = 0;
+    bool read = std::fscanf(file, "%" SCNx64, &golden) == 1;
+    std::fclose(file);
+    if (!read) {
+        std::printf("could not read golden hash from %s; this run's is %016" PRIx64 "\n", path, hash);
+        return false;
+    }
+    if (golden != hash) {
+        std::printf("hash does not match golden %016" PRIx64 " in %s\n", golden, path);
+        return false;
+    }
+    std::printf("matches golden hash in %s\n", path);
+    return true;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    int steps = argc > 1 ? std::atoi(argv[1]) : 200;
+    unsigned max_threads = argc > 2 ? static_cast<unsigned>(std::max(std::atoi(argv[2]), 1))
+                                    : std::max(std::thread::hardware_concurrency(), 4u);
+    const char* golden_path = argc > 3 ? argv[3] : nullptr;
+
+    std::printf("4005 boids, %d steps, deterministic\n", steps);
+    std::printf("%-14s %8s %18s %10s\n", "config", "threads", "hash", "seconds");
+
+    // kConfigs[0] is the grid, which the exact_neighbors runs must match.
+    uint64_t reference = 0;
+    bool ok = true;
+    for (const RunConfig& config : kConfigs) {
+        uint64_t single_thread = 0;
+        unsigned thread_counts[2] = {1, max_threads};
+        for (unsigned threads : thread_counts) {
+            double seconds = 0.0;
+            uint64_t hash = run(config, steps, threads, seconds);
+            if (threads == 1) {
+                single_thread = hash;
+                if (&config == &kConfigs[0]) reference = hash;
+            }
+            bool same = hash == single_thread && (!config.exact_neighbors || hash == reference);
+            ok = ok && same;
+            std::printf("%-14s %8u   %016" PRIx64 " %10.3f%s\n", config.name, threads, hash, seconds,
+                        same ? "" : "  MISMATCH");
+        }
+    }
+
+    if (!ok) {
+        std::printf("deterministic runs disagree\n");
+        return 1;
+    }
+    if (golden_path != nullptr && !check_golden(golden_path, reference)) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+// Measures what Morton (Z-curve) reordering of the flock state buys.
+//
+// usage: bench_morton_order [steps] [reorder_interval]
+//
+// For 10k, 50k and 100k boids, runs the same seeded flock with reordering
+// off and with a reorder every reorder_interval steps (default 10), and
+// prints the mean step time split into reorder, index build and steering.
+// On Linux the last-level cache misses of the steps are counted with
+// perf_event_open; where that is not permitted the column shows n/a.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include "sim/FlockSimulation.hpp"
+
+using namespace GLOO;
+
+namespace {
+const int kWarmupSteps = 5;
+
+// Counts hardware cache misses of this process between start() and stop().
+class CacheMissCounter {
+    public:
+        CacheMissCounter() {
+#ifdef __linux__
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.inherit = 1; // count the pool's worker threads as well
+            fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+        };
+        ~CacheMissCounter() {
+#ifdef __linux__
+            if (fd_ >= 0) close(fd_);
+#endif
+        };
+        bool available() const {
+            return fd_ >= 0;
+        };
+        void start() {
+#ifdef __linux__
+            if (fd_ < 0) return;
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+        };
+        uint64_t stop() {
+            uint64_t count = 0;
+#ifdef __linux__
+            if (fd_ < 0) return 0;
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd_, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+            return count;
+        };
+
+    private:
+        int fd_ = -1;
+};
+
+struct Result {
+    double reorder_ms = 0.0;
+    double build_ms = 0.0;
+    double steer_ms = 0.0;
+    double total_ms = 0.0;
+    uint64_t cache_misses = 0;
+};
+
+Result run(int num_boids, int steps, int reorder_interval, CacheMissCounter& counter) {
+    FlockSimulation sim;
+    sim.warn_slow_steps_ = false;
+    sim.reorder_interval_ = reorder_interval;
+    sim.spawn(num_boids, 5);
+    for (int i = 0; i < kWarmupSteps; ++i) {
+        sim.step();
+    }
+
+    Result result;
+    counter.start();
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i) {
+        sim.step();
+        const StepStats& stats = sim.get_last_stats();
+        result.reorder_ms += stats.reorder_ms;
+        result.build_ms += stats.index_build_ms;
+        result.steer_ms += stats.steer_ms;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    result.cache_misses = counter.stop();
+    result.total_ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+
+    result.reorder_ms /= steps;
+    result.build_ms /= steps;
+    result.steer_ms /= steps;
+    result.total_ms /= steps;
+    result.cache_misses /= steps;
+    return result;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    int steps = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 20;
+    int interval = argc > 2 ? std::max(std::atoi(argv[2]), 1) : 10;
+    const int sizes[] = {10000, 50000, 100000};
+
+    CacheMissCounter counter;
+    std::printf("steps: %d, reorder every %d steps (per-step means)\n", steps, interval);
+    std::printf("%8s %8s %10s %10s %10s %10s %16s\n", "boids", "reorder", "sort ms", "build ms", "steer ms", "total ms", "cache misses");
+    for (int num_boids : sizes) {
+        Result off = run(num_boids, steps, 0, counter);
+        Result on = run(num_boids, steps, interval, counter);
+        const Result* results[] = {&off, &on};
+        for (int r = 0; r < 2; ++r) {
+            const Result& result = *results[r];
+            std::printf("%8d %8s %10.3f %10.3f %10.3f %10.3f ", num_boids, r == 0 ? "off" : "on",
+                        result.reorder_ms, result.build_ms, result.steer_ms, result.total_ms);
+            if (counter.available()) {
+                std::printf("%16llu\n", static_cast<unsigned long long>(result.cache_misses));
+            } else {
+                std::printf("%16s\n", "n/a");
+            }
+        }
+        std::printf("%8d %8s %43.2fx\n", num_boids, "speedup", off.total_ms / on.total_ms);
+    }
+    return 0;
+}
@@ -0,0 +1,172 @@
+// Checks SpatialIndex::nearest() against a brute-force search.
+//
+// usage: bench_nearest [num_boids] [flocks]
+//
+// For several seeded flocks spread uniformly inside the bounds at two
+// densities, asks every index for the k nearest boids within a radius and
+// inside the view cone, for k in {1, 4, 8, 20} and several view angles and
+// radii, and compares the answer with a scan over all boids. Boids at equal
+// distance may be picked in either order, so the sorted distances are
+// compared, and every returned boid must itself pass the range and cone
+// test. The incremental grid is checked after an update() that relocated
+// boids rather than rebuilt. Any difference is printed and makes the run
+// exit with status 1. Finally times nearest() against the scan.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "sim/FlockSimulation.hpp"
+
+using namespace GLOO;
+
+namespace {
+const size_t kCounts[] = {1, 4, 8, 20};
+const float kViewAngles[] = {1.5f, 3.14f, 4.5f, 6.28f};
+const float kRadii[] = {2.f, 5.f};
+const float kDensities[] = {0.05f, 1.f};
+
+void fill_uniform(size_t n, const glm::vec3& lower, const glm::vec3& upper, std::mt19937& rng, FlockState& state) {
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    std::uniform_real_distribution<float> velocity(-1.f, 1.f);
+    state.clear();
+    for (size_t i = 0; i < n; ++i) {
+        glm::vec3 p = lower + (upper - lower) * glm::vec3(unit(rng), unit(rng), unit(rng));
+        state.push_back(p, glm::vec3(velocity(rng), velocity(rng), velocity(rng)), false);
+    }
+}
+
+// Sorted squared distances of the k nearest in range and view, by scanning.
+void brute_force(const FlockState& state, uint32_t boid, size_t k, float radius, float view_angle,
+                 std::vector<float>& dist_sq) {
+    ViewCone cone(state.velocity(boid), view_angle);
+    glm::vec3 position = state.position(boid);
+    dist_sq.clear();
+    for (size_t other = 0; other < state.size(); ++other) {
+        glm::vec3 delta = state.position(other) - position;
+        float d = glm::dot(delta, delta);
+        if (d <= radius * radius && cone.contains(delta)) {
+            dist_sq.push_back(d);
+        }
+    }
+    std::sort(dist_sq.begin(), dist_sq.end());
+    if (dist_sq.size() > k) dist_sq.resize(k);
+}
+
+// Compares one index on every boid; returns the number of queries whose
+// answer differs from the scan.
+size_t check(const char* name, const SpatialIndex& index, const FlockState& state, size_t k, float radius,
+             float view_angle) {
+    NearestNeighbors nearest;
+    std::vector<float> expected, found;
+    size_t mismatches = 0;
+    for (uint32_t i = 0; i < state.size(); ++i) {
+        brute_force(state, i, k, radius, view_angle, expected);
+        index.nearest(i, k, radius, view_angle, nearest);
+
+        ViewCone cone(state.velocity(i), view_angle);
+        bool valid = true;
+        found.clear();
+        for (const NearestNeighbors::Entry& entry : nearest.entries()) {
+            glm::vec3 delta = state.position(entry.boid) - state.position(i);
+            valid = valid && entry.dist_sq == glm::dot(delta, delta) && entry.dist_sq <= radius * radius &&
+                    cone.contains(delta);
+            found.push_back(entry.dist_sq);
+        }
+        std::sort(found.begin(), found.end());
+
+        if (!valid || found != expected) {
+            if (mismatches == 0) {
+                std::printf("  %s: boid %u differs for k %zu, radius %g, view angle %g (%zu found, %zu expected)\n",
+                            name, i, k, radius, view_angle, found.size(), expected.size());
+            }
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    int num_boids = argc > 1 ? std::atoi(argv[1]) : 2000;
+    int flocks = argc > 2 ? std::max(std::atoi(argv[2]), 1) : 2;
+
+    size_t total_mismatches = 0;
+    size_t total_checks = 0;
+    FlockState state;
+    for (int f = 0; f < flocks; ++f) {
+        for (float density : kDensities) {
+            std::mt19937 rng(1000 + f);
+            float half = 0.5f * std::cbrt(num_boids / density);
+            glm::vec3 lower(-half), upper(half);
+            fill_uniform(num_boids, lower, upper, rng, state);
+
+            // Move every boid a little after the first update, so the
+            // second one relocates instead of rebuilding.
+            IncrementalGrid incremental;
+            incremental.update(lower, upper, 2.f, state, 1.f);
+            std::uniform_real_distribution<float> jitter(-0.5f, 0.5f);
+            for (size_t i = 0; i < state.size(); ++i) {
+                glm::vec3 p = state.position(i) + glm::vec3(jitter(rng), jitter(rng), jitter(rng));
+                state.set_position(i, glm::clamp(p, lower, upper));
+            }
+            incremental.update(lower, upper, 2.f, state, 1.f);
+
+            QuadTree quadtree(lower, upper, 4, state);
+            UniformGrid grid;
+            grid.build(lower, upper, 2.f, state);
+            LinearOctree octree;
+            octree.build(lower, upper, 8, state);  // FlockSimulation's leaf capacity
+
+            for (size_t k : kCounts) {
+                for (float radius : kRadii) {
+                    for (float view_angle : kViewAngles) {
+                        total_mismatches += check("quadtree", quadtree, state, k, radius, view_angle);
+                        total_mismatches += check("uniform grid", grid, state, k, radius, view_angle);
+                        total_mismatches += check("linear octree", octree, state, k, radius, view_angle);
+                        total_mismatches += check("incremental grid", incremental, state, k, radius, view_angle);
+                        total_checks += 4 * state.size();
+                    }
+                }
+            }
+        }
+    }
+    std::printf("flocks: %d, boids: %d, densities: %zu, k values: %zu, radii: %zu, view angles: %zu\n", flocks,
+                num_boids, sizeof(kDensities) / sizeof(kDensities[0]), sizeof(kCounts) / sizeof(kCounts[0]),
+                sizeof(kRadii) / sizeof(kRadii[0]), sizeof(kViewAngles) / sizeof(kViewAngles[0]));
+    std::printf("queries compared: %zu, differing: %zu\n", total_checks, total_mismatches);
+
+    // Time one k = 8 query per boid on the last flock, grid against the scan.
+    UniformGrid grid;
+    float half = 0.5f * std::cbrt(num_boids / kDensities[1]);
+    grid.build(glm::vec3(-half), glm::vec3(half), 2.f, state);
+    NearestNeighbors nearest;
+    std::vector<float> dist_sq;
+    size_t found = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < state.size(); ++i) {
+        grid.nearest(i, 8, 2.f, 3.14f, nearest);
+        found += nearest.size();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < state.size(); ++i) {
+        brute_force(state, i, 8, 2.f, 3.14f, dist_sq);
+        found += dist_sq.size();
+    }
+    auto t2 = std::chrono::steady_clock::now();
+    // Keeps the loops from being optimized away.
+    if (found == size_t(-1)) std::printf("?");
+    std::printf("\nk = 8 per query: grid %.2f us, scan %.2f us\n",
+                std::chrono::duration<double, std::micro>(t1 - t0).count() / state.size(),
+                std::chrono::duration<double, std::micro>(t2 - t1).count() / state.size());
+
+    if (total_mismatches != 0) {
+        std::printf("\nFAILED: nearest() and the brute-force scan disagree\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,341 @@
+// Sweeps the flock simulation over boid count, density, visible range and
+// thread count to find where it stops scaling.
+//
+// usage: bench_scalability [options]
+//   --boids LIST        boid counts (default 1000,4000,16000,64000,256000,1000000)
+//   --density LIST      boids per unit volume; the world bounds are sized to
+//                       hold the count at that density (default 0.1,1)
+//   --range LIST        visible range params_[1] (default 1,2,4)
+//   --threads LIST      simulation threads (default 1 and hardware concurrency)
+//   --index grid|quadtree|octree|incremental   (default grid)
+//   --steps N           timed steps per point, after 2 warmup steps (default 10)
+//   --max-seconds X     once a point's timed steps take longer than this,
+//                       skip the larger counts of its series (default 60)
+//   --csv PATH          where to write the results (default scalability.csv)
+// LISTs are comma separated.
+//
+// Each point places its boids uniformly inside the bounds with random
+// velocities (prey only, default params otherwise) and runs FlockSimulation,
+// the simulation FlockNode drives, with neighbor stats on. The CSV has one
+// row per point: steps/s, boid-steps/s, ns per boid-step, close and visible
+// neighbors per boid and peak RSS. Points run in a child process each, so
+// the peak RSS is that point's own and a point killed for running out of
+// memory is reported rather than ending the sweep.
+//
+// The summary fits the step time of every (density, range, threads) series
+// to c * n^k. Between consecutive counts it also prints the local exponent
+// next to the one O(n log n) would give; at a fixed density the neighbors
+// per boid stay constant, so a local exponent well above the reference marks
+// the count where the neighbor search stops scaling, usually when the grid
+// or tree falls out of cache.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BOIDS_FORK_POINTS
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#endif
+
+#include "sim/FlockSimulation.hpp"
+
+using namespace GLOO;
+
+namespace {
+const int kWarmupSteps = 2;
+// Local exponents this far above O(n log n) are flagged in the summary.
+const double kSuperlinearMargin = 0.15;
+
+struct Point {
+    int num_boids;
+    float density;
+    float visible_range;
+    unsigned threads;
+};
+
+struct PointResult {
+    bool ok = false;
+    float half_extent = 0.f;
+    double seconds = 0.0;
+    double close_neighbors = 0.0;
+    double visible_neighbors = 0.0;
+    // Kilobytes; -1 where the platform cannot tell.
+    long peak_rss_kb = -1;
+};
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename T>
+bool parse_list(const char* text, std::vector<T>& values) {
+    values.clear();
+    std::string item;
+    for (const char* c = text;; ++c) {
+        if (*c == ',' || *c == '\0') {
+            if (item.empty()) return false;
+            values.push_back(static_cast<T>(std::atof(item.c_str())));
+            item.clear();
+            if (*c == '\0') break;
+        } else {
+            item += *c;
+        }
+    }
+    return true;
+}
+
+PointResult run_point(const Point& point, SpatialIndexType index_type, int steps) {
+    PointResult result;
+    FlockSimulation sim;
+    sim.warn_slow_steps_ = false;
+    sim.collect_stats_ = true;
+    sim.index_type_ = index_type;
+    sim.params_[1] = point.visible_range;
+    sim.set_thread_count(point.threads);
+
+    result.half_extent = 0.5f * std::cbrt(point.num_boids / point.density);
+    sim.lower_bounds_ = glm::vec3(-result.half_extent);
+    sim.upper_bounds_ = glm::vec3(result.half_extent);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-result.half_extent, result.half_extent);
+    std::uniform_real_distribution<float> velocity(-1.f, 1.f);
+    for (int i = 0; i < point.num_boids; ++i) {
+        sim.add_boid(glm::vec3(position(rng), position(rng), position(rng)),
+                     glm::vec3(velocity(rng), velocity(rng), velocity(rng)), false);
+    }
+
+    for (int i = 0; i < kWarmupSteps; ++i) {
+        sim.step();
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i) {
+        sim.step();
+        result.close_neighbors += sim.get_last_stats().avg_close_neighbors / steps;
+        result.visible_neighbors += sim.get_last_stats().avg_visible_neighbors / steps;
+    }
+    result.seconds = seconds_since(t0);
+    result.ok = true;
+    return result;
+}
+
+// Runs the point in a child process where possible, for its own peak RSS.
+PointResult measure(const Point& point, SpatialIndexType index_type, int steps) {
+#ifdef BOIDS_FORK_POINTS
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return run_point(point, index_type, steps);
+    }
+    std::fflush(stdout);
+    pid_t child = fork();
+    if (child == 0) {
+        close(fds[0]);
+        PointResult result = run_point(point, index_type, steps);
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+            result.peak_rss_kb = usage.ru_maxrss / 1024;
+#else
+            result.peak_rss_kb = usage.ru_maxrss;
+#endif
+        }
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == static_cast<ssize_t>(sizeof(result)) ? 0 : 1);
+    }
+    close(fds[1]);
+    PointResult result;
+    if (child > 0) {
+        PointResult received;
+        if (read(fds[0], &received, sizeof(received)) == static_cast<ssize_t>(sizeof(received))) {
+            result = received;
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+    }
+    close(fds[0]);
+    return result;
+#else
+    return run_point(point, index_type, steps);
+#endif
+}
+
+// Least-squares slope of log(y) over log(x).
+double fit_exponent(const std::vector<double>& x, const std::vector<double>& y) {
+    double n = static_cast<double>(x.size());
+    double sx = 0.0, sy = 0.0, sxx = 0.0, sxy = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        double lx = std::log(x[i]);
+        double ly = std::log(y[i]);
+        sx += lx;
+        sy += ly;
+        sxx += lx * lx;
+        sxy += lx * ly;
+    }
+    double denominator = n * sxx - sx * sx;
+    return denominator > 0.0 ? (n * sxy - sx * sy) / denominator : 0.0;
+}
+
+void usage(const char* argv0) {
+    std::fprintf(stderr,
+        "usage: %s [--boids LIST] [--density LIST] [--range LIST] [--threads LIST]\n"
+        "          [--index grid|quadtree|octree|incremental] [--steps N]\n"
+        "          [--max-seconds X] [--csv PATH]\n", argv0);
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<int> counts = {1000, 4000, 16000, 64000, 256000, 1000000};
+    std::vector<float> densities = {0.1f, 1.f};
+    std::vector<float> ranges = {1.f, 2.f, 4.f};
+    unsigned hardware_threads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<unsigned> thread_counts = {1};
+    if (hardware_threads > 1) thread_counts.push_back(hardware_threads);
+    SpatialIndexType index_type = SpatialIndexType::UniformGrid;
+    const char* index_name = "grid";
+    int steps = 10;
+    double max_seconds = 60.0;
+    const char* csv_path = "scalability.csv";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+        bool ok = true;
+        if (arg == "--boids") {
+            ok = parse_list(value, counts);
+        } else if (arg == "--density") {
+            ok = parse_list(value, densities);
+        } else if (arg == "--range") {
+            ok = parse_list(value, ranges);
+        } else if (arg == "--threads") {
+            ok = parse_list(value, thread_counts);
+        } else if (arg == "--index") {
+            std::string name = value;
+            index_name = value;
+            if (name == "grid") {
+                index_type = SpatialIndexType::UniformGrid;
+            } else if (name == "quadtree") {
+                index_type = SpatialIndexType::QuadTree;
+            } else if (name == "octree") {
+                index_type = SpatialIndexType::LinearOctree;
+            } else if (name == "incremental") {
+                index_type = SpatialIndexType::IncrementalGrid;
+            } else {
+                ok = false;
+            }
+        } else if (arg == "--steps") {
+            steps = std::max(std::atoi(value), 1);
+        } else if (arg == "--max-seconds") {
+            max_seconds = std::atof(value);
+        } else if (arg == "--csv") {
+            csv_path = value;
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    for (unsigned& threads : thread_counts) {
+        threads = std::max(threads, 1u);
+    }
+    std::sort(counts.begin(), counts.end());
+
+    FILE* csv = std::fopen(csv_path, "w");
+    if (csv == nullptr) {
+        std::fprintf(stderr, "could not write %s\n", csv_path);
+        return 1;
+    }
+    std::fprintf(csv, "index,boids,density,bounds,visible_range,threads,steps,seconds,steps_per_s,"
+                      "boid_steps_per_s,ns_per_boid_step,close_per_boid,visible_per_boid,peak_rss_mb\n");
+
+    std::printf("index: %s, %d timed steps per point\n", index_name, steps);
+    std::printf("%9s %8s %6s %7s %10s %14s %10s %10s %10s\n", "boids", "density", "range", "threads",
+                "steps/s", "boid-steps/s", "close/boid", "vis/boid", "rss MB");
+
+    struct Series {
+        Point point;
+        std::vector<double> counts;
+        std::vector<double> step_seconds;
+        int stopped_at = 0;
+    };
+    std::vector<Series> series;
+    for (float density : densities) {
+        for (float range : ranges) {
+            for (unsigned threads : thread_counts) {
+                Series s;
+                s.point = Point{0, density, range, threads};
+                for (int num_boids : counts) {
+                    Point point = s.point;
+                    point.num_boids = num_boids;
+                    PointResult result = measure(point, index_type, steps);
+                    if (!result.ok) {
+                        std::printf("%9d %8g %6g %7u   failed (out of memory?)\n", num_boids, density, range, threads);
+                        s.stopped_at = num_boids;
+                        break;
+                    }
+                    double step_seconds = result.seconds / steps;
+                    double rss_mb = result.peak_rss_kb >= 0 ? result.peak_rss_kb / 1024.0 : -1.0;
+                    std::printf("%9d %8g %6g %7u %10.2f %14.4g %10.2f %10.2f %10.1f\n", num_boids, density, range,
+                                threads, 1.0 / step_seconds, num_boids / step_seconds, result.close_neighbors,
+                                result.visible_neighbors, rss_mb);
+                    std::fprintf(csv, "%s,%d,%g,%g,%g,%u,%d,%.6f,%.4f,%.1f,%.3f,%.3f,%.3f,%.1f\n", index_name,
+                                 num_boids, density, 2.f * result.half_extent, range, threads, steps, result.seconds,
+                                 1.0 / step_seconds, num_boids / step_seconds, 1e9 * step_seconds / num_boids,
+                                 result.close_neighbors, result.visible_neighbors, rss_mb);
+                    std::fflush(csv);
+                    s.counts.push_back(num_boids);
+                    s.step_seconds.push_back(step_seconds);
+                    if (result.seconds > max_seconds && num_boids != counts.back()) {
+                        s.stopped_at = *std::upper_bound(counts.begin(), counts.end(), num_boids);
+                        std::printf("%9s over %.0f s; skipping larger counts\n", "", max_seconds);
+                        break;
+                    }
+                }
+                series.push_back(s);
+            }
+        }
+    }
+    bool csv_ok = std::fclose(csv) == 0;
+
+    std::printf("\nscaling of step time with boid count, t = c * n^k\n");
+    for (const Series& s : series) {
+        std::printf("density %g, range %g, %u threads: ", s.point.density, s.point.visible_range, s.point.threads);
+        if (s.counts.size() < 2) {
+            std::printf("too few points\n");
+            continue;
+        }
+        std::printf("k = %.2f\n", fit_exponent(s.counts, s.step_seconds));
+        for (size_t i = 1; i < s.counts.size(); ++i) {
+            double n0 = s.counts[i - 1];
+            double n1 = s.counts[i];
+            double local = std::log(s.step_seconds[i] / s.step_seconds[i - 1]) / std::log(n1 / n0);
+            double reference = std::log(n1 * std::log(n1) / (n0 * std::log(n0))) / std::log(n1 / n0);
+            std::printf("    %8.0f -> %8.0f: k = %5.2f (n log n: %.2f)%s\n", n0, n1, local, reference,
+                        local > reference + kSuperlinearMargin ? "  superlinear" : "");
+        }
+        if (s.stopped_at > 0) {
+            std::printf("    stopped before %d boids\n", s.stopped_at);
+        }
+    }
+
+    if (!csv_ok) {
+        std::fprintf(stderr, "could not write %s\n", csv_path);
+        return 1;
+    }
+    std::printf("wrote %s\n", csv_path);
+    return 0;
+}
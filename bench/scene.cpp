@@ -0,0 +1,141 @@
+// Microbenchmarks of the scene-graph side of a frame. Same flags and JSON
+// output as bench_suite (see BenchHarness.hpp).
+//
+// usage: bench_scene [--json PATH] [--filter TEXT] [--min-time SECONDS]
+//                    [--repetitions N] [--label TEXT]
+//
+// flock_update/MODE     FlockNode::Update for one simulation step of the
+//                       default 4005-boid flock, with instanced batches or
+//                       one node per boid; items are boids
+// transform_update/N    Transform::SetPositionAndRotation on N nodes, which
+//                       rebuilds the local matrix through the private
+//                       UpdateLocalTransformMatrix; items are nodes
+// render_info/N         Renderer::RetrieveRenderingInfo over N meshes in
+//                       groups of 64 under intermediate nodes, alternating
+//                       between two shaders; items are meshes
+//
+// Builds with the viewer and needs an OpenGL context for the meshes and
+// shaders, which it gets from an invisible window. Without a display:
+//   xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 ./bench_scene
+
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "BenchHarness.hpp"
+#include "gloo/Application.hpp"
+#include "gloo/Renderer.hpp"
+#include "gloo/Scene.hpp"
+#include "gloo/SceneNode.hpp"
+#include "gloo/ResourceCache.hpp"
+#include "gloo/utils.hpp"
+#include "gloo/shaders/PhongShader.hpp"
+#include "gloo/shaders/SimpleShader.hpp"
+#include "gloo/components/RenderingComponent.hpp"
+#include "gloo/components/ShadingComponent.hpp"
+#include "gloo/debug/PrimitiveFactory.hpp"
+#include "FlockNode.hpp"
+
+using namespace GLOO;
+
+namespace {
+const size_t kGroupSize = 64;
+
+// Only provides the GL context; the benchmarks build their own scenes.
+class BenchApp : public Application {
+    public:
+        BenchApp() : Application("bench_scene", glm::ivec2(64, 64), false) {}
+        void SetupScene() override {}
+};
+
+void flock_update(BenchHarness& bench) {
+    const bool modes[] = {true, false};
+    for (bool instanced : modes) {
+        std::string name = instanced ? "flock_update/instanced" : "flock_update/per_node";
+        if (!bench.enabled(name)) continue;
+        FlockNode flock;
+        flock.set_instanced_rendering(instanced);
+        FlockSimulation& sim = flock.get_simulation();
+        sim.warn_slow_steps_ = false;
+        double delta_time = 1.0 / sim.steps_per_second_;
+        bench.run(name, static_cast<double>(sim.size()), [&]() {
+            flock.Update(delta_time);
+        });
+    }
+}
+
+void transform_update(BenchHarness& bench) {
+    const size_t sizes[] = {4000, 100000};
+    for (size_t n : sizes) {
+        std::string name = "transform_update/" + std::to_string(n);
+        if (!bench.enabled(name)) continue;
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> uniform(-1.f, 1.f);
+        std::vector<std::unique_ptr<SceneNode>> nodes;
+        std::vector<glm::vec3> positions;
+        std::vector<glm::quat> rotations;
+        for (size_t i = 0; i < n; ++i) {
+            nodes.push_back(make_unique<SceneNode>());
+            positions.push_back(20.f * glm::vec3(uniform(rng), uniform(rng), uniform(rng)));
+            rotations.push_back(glm::normalize(glm::quat(uniform(rng), uniform(rng), uniform(rng), uniform(rng))));
+        }
+        bench.run(name, static_cast<double>(n), [&]() {
+            for (size_t i = 0; i < n; ++i) {
+                nodes[i]->GetTransform().SetPositionAndRotation(positions[i], rotations[i]);
+            }
+        });
+    }
+}
+
+void render_info(BenchHarness& bench, const Renderer& renderer) {
+    const size_t sizes[] = {1000, 10000, 100000};
+    std::shared_ptr<VertexObject> cone(PrimitiveFactory::CreateCone(0.2f, 0.5f, 25));
+    std::shared_ptr<ShaderProgram> shaders[2] = {
+        ResourceCache::GetInstance().GetShader<PhongShader>(),
+        ResourceCache::GetInstance().GetShader<SimpleShader>()
+    };
+    for (size_t n : sizes) {
+        std::string name = "render_info/" + std::to_string(n);
+        if (!bench.enabled(name)) continue;
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> uniform(-20.f, 20.f);
+        Scene scene(make_unique<SceneNode>());
+        SceneNode* group = nullptr;
+        for (size_t i = 0; i < n; ++i) {
+            if (i % kGroupSize == 0) {
+                std::unique_ptr<SceneNode> node = make_unique<SceneNode>();
+                group = node.get();
+                scene.GetRootNode().AddChild(std::move(node));
+            }
+            std::unique_ptr<SceneNode> mesh = make_unique<SceneNode>();
+            mesh->GetTransform().SetPosition(glm::vec3(uniform(rng), uniform(rng), uniform(rng)));
+            mesh->CreateComponent<ShadingComponent>(shaders[i % 2]);
+            mesh->CreateComponent<RenderingComponent>(cone);
+            group->AddChild(std::move(mesh));
+        }
+        size_t items = 0;
+        bench.run(name, static_cast<double>(n), [&]() {
+            items = renderer.RetrieveRenderingInfo(scene).size();
+        });
+        if (items != n) {
+            std::fprintf(stderr, "%s: retrieved %zu of %zu meshes\n", name.c_str(), items, n);
+        }
+    }
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchHarness bench("scene");
+    if (!bench.parse_args(argc, argv)) {
+        return 1;
+    }
+    std::unique_ptr<BenchApp> app = make_unique<BenchApp>();
+    Renderer renderer(*app);
+
+    flock_update(bench);
+    transform_update(bench);
+    render_info(bench, renderer);
+    return bench.finish() ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+// Checks and times the steering kernels.
+//
+// usage: bench_steering_kernel [num_boids] [steps]
+//
+// Settles a seeded flock for a few steps, then, for every boid, compares the
+// sums from each vector kernel with the scalar kernel, and the scalar kernel
+// with the neighbor-list path. It reports how many boids got different
+// close/visible counts and the largest relative difference of the steering
+// sums, and exits with status 1 if any of them disagrees with the scalar
+// kernel. Then it times full steps with each kernel.
+//
+// Every path tests the view cone as ViewCone::contains does, the vector
+// kernels lane by lane on the same floats, so they must find the same
+// neighbors and agree up to summation order.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+
+#include "sim/FlockSimulation.hpp"
+
+using namespace GLOO;
+
+namespace {
+const int kSettleSteps = 10;
+// Relative tolerance between kernels that only differ in summation order.
+const float kTolerance = 1e-4f;
+
+struct Agreement {
+    size_t count_mismatches = 0;
+    float max_relative_error = 0.f;
+};
+
+float relative_error(const glm::vec3& a, const glm::vec3& b) {
+    return glm::length(a - b) / std::max(1.f, glm::length(b));
+}
+
+// Sums the neighbor-list path would produce for boid i.
+SteeringSums list_sums(const FlockSimulation& sim, const SpatialIndex& index, uint32_t i) {
+    const FlockState& state = sim.get_state();
+    const std::vector<float>& p = sim.params_;
+    std::vector<uint32_t> close, visible;
+    index.gather(i, p[0], p[1], p[2], close, visible);
+    if (state.is_predator(i)) close.clear();
+
+    SteeringSums sums;
+    glm::vec3 position = state.position(i);
+    for (uint32_t other : close) {
+        sums.separation += position - state.position(other);
+        if (state.is_predator(other)) {
+            sums.separation += p[8] * 10 * (position - state.position(other));
+        }
+    }
+    for (uint32_t other : visible) {
+        sums.alignment += state.velocity(other);
+        sums.cohesion += state.position(other);
+    }
+    sums.close_count = static_cast<int>(close.size());
+    sums.visible_count = static_cast<int>(visible.size());
+    return sums;
+}
+
+void compare(const SteeringSums& a, const SteeringSums& b, Agreement& agreement) {
+    if (a.close_count != b.close_count || a.visible_count != b.visible_count) {
+        agreement.count_mismatches++;
+        return;
+    }
+    agreement.max_relative_error = std::max(agreement.max_relative_error, relative_error(a.separation, b.separation));
+    agreement.max_relative_error = std::max(agreement.max_relative_error, relative_error(a.alignment, b.alignment));
+    agreement.max_relative_error = std::max(agreement.max_relative_error, relative_error(a.cohesion, b.cohesion));
+}
+
+double ms_per_step(int num_boids, int steps, SteeringKernel kernel) {
+    FlockSimulation sim;
+    sim.warn_slow_steps_ = false;
+    sim.steering_kernel_ = kernel;
+    sim.spawn(num_boids, 5);
+    for (int i = 0; i < kSettleSteps; ++i) {
+        sim.step();
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i) {
+        sim.step();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(t1 - t0).count() / steps;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    int num_boids = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int steps = argc > 2 ? std::max(std::atoi(argv[2]), 1) : 20;
+
+    const SteeringKernel kernels[] = {SteeringKernel::Scalar, SteeringKernel::SSE, SteeringKernel::AVX2};
+
+    FlockSimulation sim;
+    sim.warn_slow_steps_ = false;
+    sim.spawn(num_boids, 5);
+    for (int i = 0; i < kSettleSteps; ++i) {
+        sim.step();
+    }
+    const FlockState& state = sim.get_state();
+    const std::vector<float>& p = sim.params_;
+    UniformGrid grid;
+    grid.build(sim.lower_bounds_, sim.upper_bounds_, p[1], state);
+
+    Agreement list_vs_scalar;
+    Agreement vector_vs_scalar[3];
+    std::vector<uint32_t> candidates;
+    NeighborBlock block;
+    for (uint32_t i = 0; i < state.size(); ++i) {
+        grid.candidates(i, std::max(p[0], p[1]), candidates);
+        block.load(state, candidates);
+        SteeringQuery query(state.position(i), state.velocity(i), p[0], p[1], p[2], p[8] * 10, !state.is_predator(i));
+        SteeringSums scalar = accumulate_steering(query, block, SteeringKernel::Scalar);
+        compare(list_sums(sim, grid, i), scalar, list_vs_scalar);
+        for (int k = 1; k < 3; ++k) {
+            if (steering_kernel_supported(kernels[k])) {
+                compare(accumulate_steering(query, block, kernels[k]), scalar, vector_vs_scalar[k]);
+            }
+        }
+    }
+
+    bool ok = true;
+    std::printf("boids: %zu\n", state.size());
+    std::printf("%-16s %-8s %16s %16s\n", "kernel", "vs", "count mismatches", "max rel. error");
+    std::printf("%-16s %-8s %16zu %16.3g\n", "neighbor lists", "scalar",
+                list_vs_scalar.count_mismatches, list_vs_scalar.max_relative_error);
+    ok = list_vs_scalar.count_mismatches == 0 && list_vs_scalar.max_relative_error <= kTolerance;
+    for (int k = 1; k < 3; ++k) {
+        if (!steering_kernel_supported(kernels[k])) {
+            std::printf("%-16s %-8s %16s\n", steering_kernel_name(kernels[k]), "scalar", "unsupported");
+            continue;
+        }
+        const Agreement& agreement = vector_vs_scalar[k];
+        std::printf("%-16s %-8s %16zu %16.3g\n", steering_kernel_name(kernels[k]), "scalar",
+                    agreement.count_mismatches, agreement.max_relative_error);
+        ok = ok && agreement.count_mismatches == 0 && agreement.max_relative_error <= kTolerance;
+    }
+
+    std::printf("\n%-16s %12s\n", "kernel", "ms/step");
+    std::printf("%-16s %12.3f\n", "neighbor lists", ms_per_step(num_boids, steps, SteeringKernel::NeighborLists));
+    for (SteeringKernel kernel : kernels) {
+        if (steering_kernel_supported(kernel)) {
+            std::printf("%-16s %12.3f\n", steering_kernel_name(kernel), ms_per_step(num_boids, steps, kernel));
+        }
+    }
+
+    if (!ok) {
+        std::printf("\nFAILED: kernels disagree with the scalar kernel\n");
+        return 1;
+    }
+    return 0;
+}
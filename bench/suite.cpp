@@ -0,0 +1,145 @@
+// Microbenchmarks of the simulation hot paths, for tracking regressions
+// across versions. Flags and JSON output are described in BenchHarness.hpp.
+//
+// usage: bench_suite [--json PATH] [--filter TEXT] [--min-time SECONDS]
+//                    [--repetitions N] [--label TEXT]
+//
+// quadtree_build/N      QuadTree over N boids spread uniformly at one boid
+//                       per unit volume, 1k to 1M
+// quadtree_query/D/R    QuadTree::query of 1000 boids out of 100k at D boids
+//                       per unit volume and radius R; items are queries
+// step/INDEX/N          one FlockSimulation::step of a spawned flock on every
+//                       hardware thread; 4005 boids is the flock FlockNode's
+//                       default constructor sets up
+//
+// The GL-side benchmarks (FlockNode::Update, transforms, render info) are in
+// bench_scene, which builds with the viewer.
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include "BenchHarness.hpp"
+#include "sim/FlockSimulation.hpp"
+
+using namespace GLOO;
+
+namespace {
+const int kQuadTreeCapacity = 4;
+const float kViewAngle = 3.14f;
+const int kQueriesPerIteration = 1000;
+const int kPredators = 5;
+
+// n boids uniformly in a cube centered on the origin, density per unit volume.
+void fill_uniform(size_t n, float density, FlockState& state, glm::vec3& lower, glm::vec3& upper) {
+    float half = 0.5f * std::cbrt(n / density);
+    lower = glm::vec3(-half);
+    upper = glm::vec3(half);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-half, half);
+    std::uniform_real_distribution<float> velocity(-1.f, 1.f);
+    state.clear();
+    state.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        glm::vec3 p(position(rng), position(rng), position(rng));
+        glm::vec3 v(velocity(rng), velocity(rng), velocity(rng));
+        state.push_back(p, v, false);
+    }
+}
+
+void quadtree_build(BenchHarness& bench) {
+    const size_t sizes[] = {1000, 10000, 100000, 1000000};
+    for (size_t n : sizes) {
+        std::string name = "quadtree_build/" + std::to_string(n);
+        if (!bench.enabled(name)) continue;
+        FlockState state;
+        glm::vec3 lower, upper;
+        fill_uniform(n, 1.f, state, lower, upper);
+        size_t nodes = 0;
+        BenchResult& result = bench.run(name, static_cast<double>(n), [&]() {
+            QuadTree tree(lower, upper, kQuadTreeCapacity, state);
+            nodes = tree.node_count();
+        });
+        result.counters.push_back(std::make_pair("nodes", static_cast<double>(nodes)));
+    }
+}
+
+void quadtree_query(BenchHarness& bench) {
+    const size_t n = 100000;
+    const float densities[] = {0.25f, 1.f, 4.f};
+    const float radii[] = {0.5f, 1.f, 2.f, 4.f};
+    for (float density : densities) {
+        FlockState state;
+        glm::vec3 lower, upper;
+        std::unique_ptr<QuadTree> tree;
+        for (float radius : radii) {
+            char name[64];
+            std::snprintf(name, sizeof(name), "quadtree_query/%g/%g", density, radius);
+            if (!bench.enabled(name)) continue;
+            if (!tree) {
+                fill_uniform(n, density, state, lower, upper);
+                tree.reset(new QuadTree(lower, upper, kQuadTreeCapacity, state));
+            }
+            std::vector<uint32_t> found;
+            uint32_t next = 0;
+            size_t total_found = 0;
+            size_t queries = 0;
+            BenchResult& result = bench.run(name, kQueriesPerIteration, [&]() {
+                for (int q = 0; q < kQueriesPerIteration; ++q) {
+                    found.clear();
+                    tree->query(next, radius, kViewAngle, found);
+                    total_found += found.size();
+                    next = (next + 7919) % n;
+                }
+                queries += kQueriesPerIteration;
+            });
+            result.counters.push_back(std::make_pair("neighbors_per_query", static_cast<double>(total_found) / queries));
+        }
+    }
+}
+
+void simulation_step(BenchHarness& bench) {
+    struct IndexName {
+        SpatialIndexType type;
+        const char* name;
+    };
+    const IndexName indexes[] = {
+        {SpatialIndexType::UniformGrid, "grid"},
+        {SpatialIndexType::QuadTree, "quadtree"},
+        {SpatialIndexType::LinearOctree, "octree"},
+        {SpatialIndexType::IncrementalGrid, "incremental"}
+    };
+    const int sizes[] = {4000, 20000};
+    for (const IndexName& index : indexes) {
+        for (int num_boids : sizes) {
+            std::string name = std::string("step/") + index.name + "/" + std::to_string(num_boids + kPredators);
+            if (!bench.enabled(name)) continue;
+            FlockSimulation sim;
+            sim.warn_slow_steps_ = false;
+            sim.index_type_ = index.type;
+            sim.set_time_step_size(0.1f);
+            sim.set_thread_count(std::max(std::thread::hardware_concurrency(), 1u));
+            sim.spawn(num_boids, kPredators);
+            bench.run(name, static_cast<double>(sim.size()), [&]() {
+                sim.step();
+            });
+        }
+    }
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    BenchHarness bench("sim");
+    if (!bench.parse_args(argc, argv)) {
+        return 1;
+    }
+    quadtree_build(bench);
+    quadtree_query(bench);
+    simulation_step(bench);
+    return bench.finish() ? 0 : 1;
+}
@@ -0,0 +1,56 @@
+// Measures how FlockSimulation::step scales with the thread pool size.
+//
+// usage: bench_thread_scaling [num_boids] [steps] [max_threads]
+//
+// Runs the same seeded flock once per thread count from 1 to max_threads and
+// prints boids per second along with the speedup over one thread.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <algorithm>
+
+#include "sim/FlockSimulation.hpp"
+
+using namespace GLOO;
+
+namespace {
+const int kWarmupSteps = 5;
+
+double run(int num_boids, int steps, unsigned num_threads) {
+    FlockSimulation sim;
+    sim.warn_slow_steps_ = false;
+    sim.set_thread_count(num_threads);
+    sim.spawn(num_boids, 5);
+    for (int i = 0; i < kWarmupSteps; ++i) {
+        sim.step();
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < steps; ++i) {
+        sim.step();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(t1 - t0).count();
+    return static_cast<double>(sim.size()) * steps / seconds;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    int num_boids = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int steps = argc > 2 ? std::atoi(argv[2]) : 50;
+    unsigned max_threads = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3]))
+                                    : std::max(std::thread::hardware_concurrency(), 1u);
+
+    std::printf("boids: %d, steps: %d\n", num_boids, steps);
+    std::printf("%8s %16s %10s\n", "threads", "boids/s", "speedup");
+
+    double baseline = 0.0;
+    for (unsigned threads = 1; threads <= max_threads; ++threads) {
+        double rate = run(num_boids, steps, threads);
+        if (threads == 1) baseline = rate;
+        std::printf("%8u %16.0f %9.2fx\n", threads, rate, rate / baseline);
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+// Compares the pointer-based QuadTree with the arena-built LinearOctree.
+//
+// usage: bench_tree_build [reps]
+//
+// For several flock sizes, builds each tree reps times over the same
+// positions and prints the average build time and node count, then the
+// average time of one neighbor gather for every boid. Each tree's neighbor
+// lists are checked against the uniform grid's as well; the QuadTree skips
+// boids outside the bounds, so on a fresh spawn it mismatches near the edges.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+#include "sim/FlockSimulation.hpp"
+
+using namespace GLOO;
+
+namespace {
+const float kCloseRange = 1.f;
+const float kVisibleRange = 2.f;
+const float kViewAngle = 3.14f;
+
+using Clock = std::chrono::steady_clock;
+
+double ms_since(Clock::time_point t0) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+// Milliseconds to gather every boid's neighbors.
+double gather_all(const SpatialIndex& index, size_t n) {
+    std::vector<uint32_t> close, visible;
+    auto t0 = Clock::now();
+    for (uint32_t i = 0; i < n; ++i) {
+        index.gather(i, kCloseRange, kVisibleRange, kViewAngle, close, visible);
+    }
+    return ms_since(t0);
+}
+
+// Number of boids whose sorted neighbor lists differ between the two indexes.
+size_t mismatches(const SpatialIndex& a, const SpatialIndex& b, size_t n) {
+    std::vector<uint32_t> close_a, visible_a, close_b, visible_b;
+    size_t count = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        a.gather(i, kCloseRange, kVisibleRange, kViewAngle, close_a, visible_a);
+        b.gather(i, kCloseRange, kVisibleRange, kViewAngle, close_b, visible_b);
+        std::sort(close_a.begin(), close_a.end());
+        std::sort(visible_a.begin(), visible_a.end());
+        std::sort(close_b.begin(), close_b.end());
+        std::sort(visible_b.begin(), visible_b.end());
+        // the QuadTree can list a boid twice when it sits on a split plane
+        close_a.erase(std::unique(close_a.begin(), close_a.end()), close_a.end());
+        visible_a.erase(std::unique(visible_a.begin(), visible_a.end()), visible_a.end());
+        if (close_a != close_b || visible_a != visible_b) ++count;
+    }
+    return count;
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    int reps = argc > 1 ? std::max(std::atoi(argv[1]), 1) : 20;
+    const int sizes[] = {1000, 4000, 16000, 64000};
+
+    std::printf("%8s %-14s %10s %10s %12s %10s\n", "boids", "index", "build ms", "nodes", "gather ms", "mismatch");
+    for (int num_boids : sizes) {
+        FlockSimulation sim;
+        sim.spawn(num_boids, 5);
+        const FlockState& state = sim.get_state();
+        size_t n = state.size();
+
+        UniformGrid grid;
+        grid.build(sim.lower_bounds_, sim.upper_bounds_, kVisibleRange, state);
+
+        std::unique_ptr<QuadTree> quadtree;
+        auto t0 = Clock::now();
+        for (int r = 0; r < reps; ++r) {
+            quadtree.reset(new QuadTree(sim.lower_bounds_, sim.upper_bounds_, 4, state));
+        }
+        double quadtree_ms = ms_since(t0) / reps;
+        std::printf("%8zu %-14s %10.3f %10zu %12.2f %10zu\n", n, "quadtree", quadtree_ms,
+                    quadtree->node_count(), gather_all(*quadtree, n), mismatches(*quadtree, grid, n));
+
+        LinearOctree octree;
+        t0 = Clock::now();
+        for (int r = 0; r < reps; ++r) {
+            octree.build(sim.lower_bounds_, sim.upper_bounds_, 8, state);
+        }
+        double octree_ms = ms_since(t0) / reps;
+        std::printf("%8zu %-14s %10.3f %10zu %12.2f %10zu\n", n, "linear octree", octree_ms,
+                    octree.get_node_count(), gather_all(octree, n), mismatches(octree, grid, n));
+    }
+    return 0;
+}
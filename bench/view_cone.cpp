@@ -0,0 +1,150 @@
+// Checks the dot-product view cone against the arccosine test it replaced.
+//
+// usage: bench_view_cone [num_boids] [flocks]
+//
+// For several seeded random flocks and view angles on both sides of 180
+// degrees, runs query() and gather() on every index and compares each
+// visible set with the candidates the old formulation,
+// acos(dot(dir, normalize(delta))) <= view_angle / 2, would keep. Any
+// difference is printed and makes the run exit with status 1. Finally times
+// the two predicates on random directions.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include "sim/FlockSimulation.hpp"
+
+using namespace GLOO;
+
+namespace {
+const float kViewAngles[] = {0.5f, 1.5f, 3.14159265f, 4.5f, 6.0f, 6.28f};
+const float kRadius = 3.0f;
+
+// The per-pair test QuadTree::query and FlockNode used before ViewCone.
+bool acos_in_view(const glm::vec3& velocity, const glm::vec3& delta, float view_angle) {
+    if (view_angle >= 6.28f) return true;
+    float angle = glm::acos(glm::dot(glm::normalize(velocity), glm::normalize(delta)));
+    return !(angle > view_angle / 2.0f);
+}
+
+// Visible set of boid under the old test, drawn from the index's candidates.
+void reference(const SpatialIndex& index, const FlockState& state, uint32_t boid, float view_angle,
+               std::vector<uint32_t>& candidates, std::vector<uint32_t>& found) {
+    index.candidates(boid, kRadius, candidates);
+    found.clear();
+    for (uint32_t other : candidates) {
+        glm::vec3 delta = state.position(other) - state.position(boid);
+        if (glm::dot(delta, delta) <= kRadius * kRadius && acos_in_view(state.velocity(boid), delta, view_angle)) {
+            found.push_back(other);
+        }
+    }
+    std::sort(found.begin(), found.end());
+}
+
+// Compares one index on every boid; returns the number of boids whose
+// visible set differs in query() or gather().
+size_t check(const char* name, const SpatialIndex& index, const FlockState& state, float view_angle) {
+    std::vector<uint32_t> candidates, expected, found, close;
+    size_t mismatches = 0;
+    for (uint32_t i = 0; i < state.size(); ++i) {
+        reference(index, state, i, view_angle, candidates, expected);
+
+        found.clear();
+        index.query(i, kRadius, view_angle, found);
+        std::sort(found.begin(), found.end());
+        bool same = found == expected;
+
+        index.gather(i, 0.5f * kRadius, kRadius, view_angle, close, found);
+        std::sort(found.begin(), found.end());
+        same = same && found == expected;
+
+        if (!same) {
+            if (mismatches == 0) {
+                std::printf("  %s: boid %u differs at view angle %.3f\n", name, i, view_angle);
+            }
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+double ns_per_test(bool use_cone, float view_angle, const std::vector<glm::vec3>& v, const std::vector<glm::vec3>& d) {
+    size_t inside = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    if (use_cone) {
+        for (size_t i = 0; i < v.size(); ++i) {
+            ViewCone cone(v[i], view_angle);
+            for (size_t j = 0; j < d.size(); ++j) {
+                inside += cone.contains(d[j]);
+            }
+        }
+    } else {
+        for (size_t i = 0; i < v.size(); ++i) {
+            for (size_t j = 0; j < d.size(); ++j) {
+                inside += acos_in_view(v[i], d[j], view_angle);
+            }
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    // Keeps the loops from being optimized away.
+    if (inside == size_t(-1)) std::printf("?");
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / (v.size() * d.size());
+}
+} // namespace
+
+int main(int argc, char** argv) {
+    int num_boids = argc > 1 ? std::atoi(argv[1]) : 5000;
+    int flocks = argc > 2 ? std::max(std::atoi(argv[2]), 1) : 4;
+
+    size_t total_mismatches = 0;
+    size_t total_checks = 0;
+    for (int f = 0; f < flocks; ++f) {
+        FlockSimulation sim;
+        sim.warn_slow_steps_ = false;
+        sim.seed(1000 + f);
+        sim.spawn(num_boids, 5);
+        // A few steps so the flock has formed clusters and aligned headings.
+        for (int i = 0; i < 5 * f; ++i) {
+            sim.step();
+        }
+        const FlockState& state = sim.get_state();
+
+        QuadTree quadtree(sim.lower_bounds_, sim.upper_bounds_, 4, state);
+        UniformGrid grid;
+        grid.build(sim.lower_bounds_, sim.upper_bounds_, kRadius, state);
+        LinearOctree octree;
+        octree.build(sim.lower_bounds_, sim.upper_bounds_, 8, state);  // FlockSimulation's leaf capacity
+
+        for (float view_angle : kViewAngles) {
+            total_mismatches += check("quadtree", quadtree, state, view_angle);
+            total_mismatches += check("uniform grid", grid, state, view_angle);
+            total_mismatches += check("linear octree", octree, state, view_angle);
+            total_checks += 3 * state.size();
+        }
+    }
+    std::printf("flocks: %d, boids: %d, view angles: %zu\n", flocks, num_boids,
+                sizeof(kViewAngles) / sizeof(kViewAngles[0]));
+    std::printf("visible sets compared: %zu, differing: %zu\n", total_checks, total_mismatches);
+
+    std::default_random_engine rng(7);
+    std::normal_distribution<float> normal;
+    std::vector<glm::vec3> v(256), d(4096);
+    for (glm::vec3& x : v) x = glm::vec3(normal(rng), normal(rng), normal(rng));
+    for (glm::vec3& x : d) x = glm::vec3(normal(rng), normal(rng), normal(rng));
+    std::printf("\n%-12s %12s %12s\n", "view angle", "acos ns", "cone ns");
+    for (float view_angle : {1.5f, 4.5f}) {
+        std::printf("%-12.2f %12.2f %12.2f\n", view_angle,
+                    ns_per_test(false, view_angle, v, d), ns_per_test(true, view_angle, v, d));
+    }
+
+    if (total_mismatches != 0) {
+        std::printf("\nFAILED: dot-product cone and acos test disagree\n");
+        return 1;
+    }
+    return 0;
+}
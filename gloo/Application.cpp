@@ -4,11 +4,14 @@
 
 #include "gloo/utils.hpp"
 #include "gloo/InputManager.hpp"
+#include "sim/Profiler.hpp"
 
 namespace GLOO {
-Application::Application(std::string app_name, glm::ivec2 window_size)
+Application::Application(std::string app_name,
+                         glm::ivec2 window_size,
+                         bool visible)
     : app_name_(app_name), window_size_(window_size) {
-  InitializeGLFW();
+  InitializeGLFW(visible);
   InitializeGUI();
 
   scene_ = make_unique<Scene>(make_unique<SceneNode>());
@@ -25,11 +28,12 @@ Application::~Application() {
   glfwTerminate();
 }
 
-void Application::InitializeGLFW() {
+void Application::InitializeGLFW(bool visible) {
   glfwInit();
   glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
   glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
   glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  glfwWindowHint(GLFW_VISIBLE, visible ? GLFW_TRUE : GLFW_FALSE);
 
 #ifdef __APPLE__
   glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
@@ -106,18 +110,33 @@ void Application::DestroyGUI() {
 }
 
 void Application::Tick(double delta_time, double current_time) {
-  // Process window events.
-  glfwPollEvents();
-  UpdateGUI();
-
-  // Logic update before rendering.
-  scene_->Update(delta_time);
-
-  // Rendering scene and GUI.
-  renderer_->Render(*scene_);
-  RenderGUI();
-
-  glfwSwapBuffers(window_handle_);
+  {
+    PROFILE_SCOPE("frame");
+    // Process window events.
+    glfwPollEvents();
+    {
+      PROFILE_SCOPE("gui");
+      UpdateGUI();
+    }
+
+    // Logic update before rendering.
+    scene_->Update(delta_time);
+
+    // Rendering scene and GUI. GL calls are timed as submitted on the CPU;
+    // the GPU catches up in swap buffers.
+    {
+      PROFILE_SCOPE("render");
+      renderer_->Render(*scene_);
+    }
+    {
+      PROFILE_SCOPE("gui render");
+      RenderGUI();
+    }
+
+    PROFILE_SCOPE("swap buffers");
+    glfwSwapBuffers(window_handle_);
+  }
+  PROFILE_FRAME();
 }
 
 void Application::FramebufferSizeCallback(glm::ivec2 window_size) {
@@ -11,7 +11,11 @@
 namespace GLOO {
 class Application {
  public:
-  Application(std::string app_name, glm::ivec2 window_size);
+  // An invisible window still gets a full GL context, so frame times can be
+  // measured offscreen (e.g. under Xvfb with Mesa's llvmpipe).
+  Application(std::string app_name,
+              glm::ivec2 window_size,
+              bool visible = true);
   virtual ~Application();
   bool IsFinished();
   void Tick(double delta_time, double current_time);
@@ -28,7 +32,7 @@ class Application {
   std::unique_ptr<Scene> scene_;
 
  private:
-  void InitializeGLFW();
+  void InitializeGLFW(bool visible);
   void InitializeGUI();
   void SetRenderingOptions();
   void UpdateGUI();
@@ -1,4 +1,5 @@
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <glad/glad.h>
@@ -9,6 +10,7 @@
 #include "utils.hpp"
 #include "gl_wrapper/BindGuard.hpp"
 #include "shaders/ShaderProgram.hpp"
+#include "sim/Profiler.hpp"
 #include "components/ShadingComponent.hpp"
 #include "components/CameraComponent.hpp"
 #include "debug/PrimitiveFactory.hpp"
@@ -37,6 +39,7 @@ void Renderer::Render(const Scene& scene) const {
 
 Renderer::RenderingInfo Renderer::RetrieveRenderingInfo(
     const Scene& scene) const {
+  PROFILE_SCOPE("render info");
   RenderingInfo info;
   const SceneNode& root = scene.GetRootNode();
   // TODO: Below is an inefficient implementation that computes local-to-world
@@ -48,6 +51,13 @@ Renderer::RenderingInfo Renderer::RetrieveRenderingInfo(
   // should create your own recursive function that collects
   // std::pair<RenderingComponent*, glm::mat4>.
   RecursiveRetrieve(root, info, glm::mat4(1.f));
+
+  // Group by shader so RenderPass binds each program and sets its camera and
+  // light uniforms once. Stable, so nodes sharing a shader keep scene order.
+  std::stable_sort(info.begin(), info.end(),
+                   [](const RenderingItem& a, const RenderingItem& b) {
+                     return a.shader < b.shader;
+                   });
   return info;
 }
 
@@ -56,7 +66,13 @@ void Renderer::RecursiveRetrieve(const SceneNode& node, RenderingInfo& info, con
   glm::mat4 new_matrix = model_matrix * node.GetTransform().GetLocalToParentMatrix();
   auto rendering_ptr = node.GetComponentPtr<RenderingComponent>();
   if (rendering_ptr != nullptr && node.IsActive()) {
-    info.emplace_back(rendering_ptr, new_matrix);
+    auto shading_ptr = node.GetComponentPtr<ShadingComponent>();
+    if (shading_ptr == nullptr) {
+      std::cerr << "Some mesh is not attached with a shader during rendering!"
+                << std::endl;
+    } else {
+      info.push_back({rendering_ptr, shading_ptr->GetShaderPtr(), new_matrix});
+    }
   }
 
   for (size_t i = 0; i < node.GetChildrenCount(); i++) {
@@ -86,64 +102,51 @@ void Renderer::RenderScene(const Scene& scene) const {
     // assignment 5. If you are interested in learning more, see
     // https://www.khronos.org/opengl/wiki/Early_Fragment_Test#Optimization
 
+    PROFILE_SCOPE("depth pass");
     GL_CHECK(glDepthMask(GL_TRUE));
     bool color_mask = GL_FALSE;
     GL_CHECK(glColorMask(color_mask, color_mask, color_mask, color_mask));
 
-    for (const auto& pr : rendering_info) {
-      auto robj_ptr = pr.first;
-      SceneNode& node = *robj_ptr->GetNodePtr();
-      auto shading_ptr = node.GetComponentPtr<ShadingComponent>();
-      if (shading_ptr == nullptr) {
-        std::cerr << "Some mesh is not attached with a shader during rendering!"
-                  << std::endl;
-        continue;
-      }
-      ShaderProgram* shader = shading_ptr->GetShaderPtr();
-
-      BindGuard shader_bg(shader);
-
-      // Set various uniform variables in the shaders.
-      shader->SetTargetNode(node, pr.second);
-      shader->SetCamera(*camera);
-
-      robj_ptr->Render();
-    }
+    RenderPass(rendering_info, *camera, nullptr);
   }
 
   // The real shadow map/Phong shading passes.
   for (size_t light_id = 0; light_id < light_ptrs.size(); light_id++) {
-
+    PROFILE_SCOPE("light pass");
     GL_CHECK(glDepthMask(GL_FALSE));
     bool color_mask = GL_TRUE;
     GL_CHECK(glColorMask(color_mask, color_mask, color_mask, color_mask));
 
-    for (const auto& pr : rendering_info) {
-      auto robj_ptr = pr.first;
-      SceneNode& node = *robj_ptr->GetNodePtr();
-      auto shading_ptr = node.GetComponentPtr<ShadingComponent>();
-      if (shading_ptr == nullptr) {
-        std::cerr << "Some mesh is not attached with a shader during rendering!"
-                  << std::endl;
-        continue;
-      }
-      ShaderProgram* shader = shading_ptr->GetShaderPtr();
-
-      BindGuard shader_bg(shader);
-
-      // Set various uniform variables in the shaders.
-      shader->SetTargetNode(node, pr.second);
-      shader->SetCamera(*camera);
-
-      LightComponent& light = *light_ptrs.at(light_id);
-      shader->SetLightSource(light);
-
-      robj_ptr->Render();
-    }
+    RenderPass(rendering_info, *camera, light_ptrs.at(light_id));
   }
 
   // Re-enable writing to depth buffer.
   GL_CHECK(glDepthMask(GL_TRUE));
 }
 
+void Renderer::RenderPass(const RenderingInfo& info,
+                          const CameraComponent& camera,
+                          const LightComponent* light) const {
+  const ShaderProgram* bound_shader = nullptr;
+  for (const auto& item : info) {
+    if (item.shader != bound_shader) {
+      bound_shader = item.shader;
+      bound_shader->Bind();
+      // Per-pass state, once per program.
+      bound_shader->SetCamera(camera);
+      if (light != nullptr) {
+        bound_shader->SetLightSource(*light);
+      }
+    }
+
+    // Only per-object uniforms inside the loop.
+    bound_shader->SetTargetNode(*item.rendering->GetNodePtr(),
+                                item.model_matrix);
+    item.rendering->Render();
+  }
+  if (bound_shader != nullptr) {
+    bound_shader->Unbind();
+  }
+}
+
 }  // namespace GLOO
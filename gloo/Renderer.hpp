@@ -8,18 +8,35 @@
 
 namespace GLOO {
 class Scene;
+class ShaderProgram;
+class CameraComponent;
 class Application;
 class Renderer {
  public:
   Renderer(Application& application);
   void Render(const Scene& scene) const;
 
+  struct RenderingItem {
+    RenderingComponent* rendering;
+    ShaderProgram* shader;
+    glm::mat4 model_matrix;
+  };
+  using RenderingInfo = std::vector<RenderingItem>;
+  // Active meshes with their model matrices, grouped by shader. Public so
+  // bench_scene can time it apart from the draw calls.
+  RenderingInfo RetrieveRenderingInfo(const Scene& scene) const;
+
  private:
-  using RenderingInfo = std::vector<std::pair<RenderingComponent*, glm::mat4>>;
   void RenderScene(const Scene& scene) const;
   void SetRenderingOptions() const;
+  // Draws every item once. Items must be grouped by shader: camera and light
+  // uniforms are uploaded only when the shader changes, so per-frame state
+  // costs one upload per program rather than one per node. light may be
+  // null for the depth prepass.
+  void RenderPass(const RenderingInfo& info,
+                  const CameraComponent& camera,
+                  const LightComponent* light) const;
 
-  RenderingInfo RetrieveRenderingInfo(const Scene& scene) const;
   void RecursiveRetrieve(const SceneNode& node, RenderingInfo& info, const glm::mat4& model_matrix) const;
 
   Application& application_;
@@ -0,0 +1,39 @@
+#include "ResourceCache.hpp"
+
+#include <sstream>
+
+#include "gloo/debug/PrimitiveFactory.hpp"
+
+namespace GLOO {
+std::shared_ptr<VertexObject> ResourceCache::GetSphere(float r,
+                                                       size_t slices,
+                                                       size_t stacks) {
+  std::ostringstream key;
+  key << "sphere:" << r << ":" << slices << ":" << stacks;
+  return GetMesh(key.str(), [=]() {
+    return PrimitiveFactory::CreateSphere(r, slices, stacks);
+  });
+}
+
+std::shared_ptr<VertexObject> ResourceCache::GetCone(float r,
+                                                     float h,
+                                                     size_t num_sides) {
+  std::ostringstream key;
+  key << "cone:" << r << ":" << h << ":" << num_sides;
+  return GetMesh(key.str(), [=]() {
+    return PrimitiveFactory::CreateCone(r, h, num_sides);
+  });
+}
+
+std::shared_ptr<VertexObject> ResourceCache::GetMesh(
+    const std::string& key,
+    const std::function<std::unique_ptr<VertexObject>()>& create) {
+  std::weak_ptr<VertexObject>& entry = meshes_[key];
+  std::shared_ptr<VertexObject> mesh = entry.lock();
+  if (mesh == nullptr) {
+    mesh = create();
+    entry = mesh;
+  }
+  return mesh;
+}
+}  // namespace GLOO
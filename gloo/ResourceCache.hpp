@@ -0,0 +1,60 @@
+#ifndef GLOO_RESOURCE_CACHE_H_
+#define GLOO_RESOURCE_CACHE_H_
+
+#include <memory>
+#include <string>
+#include <functional>
+#include <typeindex>
+#include <unordered_map>
+
+#include "gloo/VertexObject.hpp"
+#include "gloo/shaders/ShaderProgram.hpp"
+
+namespace GLOO {
+// Hands out shared GPU resources so that nodes built from the same primitive
+// or shader type reuse one VAO/program instead of creating their own.
+// Entries are held weakly: a resource is freed once the last node using it
+// is gone, and the cache never touches GL after the context is destroyed.
+class ResourceCache {
+ public:
+  // Singleton design pattern, like InputManager.
+  static ResourceCache& GetInstance() {
+    static ResourceCache _instance;
+    return _instance;
+  }
+
+  ResourceCache(const ResourceCache&) = delete;
+  void operator=(const ResourceCache&) = delete;
+
+  // Same arguments as the PrimitiveFactory counterparts.
+  std::shared_ptr<VertexObject> GetSphere(float r,
+                                          size_t slices,
+                                          size_t stacks);
+  std::shared_ptr<VertexObject> GetCone(float r, float h, size_t num_sides);
+
+  // One program per shader class T, which must be default-constructible.
+  template <class T>
+  std::shared_ptr<T> GetShader() {
+    std::weak_ptr<ShaderProgram>& entry = shaders_[std::type_index(typeid(T))];
+    std::shared_ptr<ShaderProgram> shader = entry.lock();
+    if (shader == nullptr) {
+      shader = std::make_shared<T>();
+      entry = shader;
+    }
+    return std::static_pointer_cast<T>(shader);
+  }
+
+ private:
+  ResourceCache() {
+  }
+
+  std::shared_ptr<VertexObject> GetMesh(
+      const std::string& key,
+      const std::function<std::unique_ptr<VertexObject>()>& create);
+
+  std::unordered_map<std::string, std::weak_ptr<VertexObject>> meshes_;
+  std::unordered_map<std::type_index, std::weak_ptr<ShaderProgram>> shaders_;
+};
+}  // namespace GLOO
+
+#endif
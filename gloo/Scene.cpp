@@ -1,8 +1,11 @@
 #include "Scene.hpp"
 
+#include "sim/Profiler.hpp"
+
 namespace GLOO {
 
 void Scene::Update(double delta_time) {
+  PROFILE_SCOPE("scene update");
   RecursiveUpdate(*root_node_, delta_time);
 }
 
@@ -32,6 +32,13 @@ void Transform::SetRotation(const glm::vec3& axis, float angle) {
                         axis.y * sinf(angle / 2), axis.z * sinf(angle / 2)));
 }
 
+void Transform::SetPositionAndRotation(const glm::vec3& position,
+                                       const glm::quat& rotation) {
+  position_ = position;
+  rotation_ = rotation;
+  UpdateLocalTransformMatrix();
+}
+
 void Transform::SetScale(const glm::vec3& scale) {
   scale_ = scale;
   UpdateLocalTransformMatrix();
@@ -14,6 +14,9 @@ class Transform {
   void SetPosition(const glm::vec3& position);
   void SetRotation(const glm::quat& rotation);
   void SetRotation(const glm::vec3& axis, float angle);
+  // Sets both at once so the local matrix is only rebuilt once.
+  void SetPositionAndRotation(const glm::vec3& position,
+                              const glm::quat& rotation);
   void SetScale(const glm::vec3& scale);
   void SetMatrix4x4(const glm::mat4& T);
   glm::vec3 GetPosition() const {
@@ -18,7 +18,7 @@ class ComponentBase {
   }
 
  protected:
-  SceneNode* node_ptr_;
+  SceneNode* node_ptr_ = nullptr;
 };
 }  // namespace GLOO
 
@@ -14,6 +14,7 @@ enum class ComponentType {
   Camera,
   Light,
   Tracing,
+  Instancing,
 };
 
 template <typename T>
@@ -0,0 +1,35 @@
+#include "InstancingComponent.hpp"
+
+#include <stdexcept>
+
+namespace GLOO {
+InstancingComponent::InstancingComponent()
+    : position_scale_buf_(make_unique<InstanceBuffer>(GL_DYNAMIC_DRAW)),
+      rotation_buf_(make_unique<InstanceBuffer>(GL_DYNAMIC_DRAW)),
+      instance_count_(0) {
+}
+
+void InstancingComponent::UpdateInstances(
+    const std::vector<glm::vec4>& position_scales,
+    const std::vector<glm::vec4>& rotations) {
+  if (position_scales.size() != rotations.size()) {
+    throw std::runtime_error(
+        "Instance positions and rotations differ in length!");
+  }
+  position_scale_buf_->Update(position_scales);
+  rotation_buf_->Update(rotations);
+  instance_count_ = position_scales.size();
+}
+
+void InstancingComponent::LinkBuffers(const VertexArray& vertex_array,
+                                      GLint position_scale_loc,
+                                      GLint rotation_loc) const {
+  if (position_scale_loc != -1) {
+    vertex_array.LinkInstanceBuffer(*position_scale_buf_, position_scale_loc,
+                                    4);
+  }
+  if (rotation_loc != -1) {
+    vertex_array.LinkInstanceBuffer(*rotation_buf_, rotation_loc, 4);
+  }
+}
+}  // namespace GLOO
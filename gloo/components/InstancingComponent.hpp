@@ -0,0 +1,50 @@
+#ifndef GLOO_INSTANCING_COMPONENT_H_
+#define GLOO_INSTANCING_COMPONENT_H_
+
+#include "ComponentBase.hpp"
+
+#include <memory>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "gloo/gl_wrapper/VertexArray.hpp"
+#include "gloo/gl_wrapper/VertexBuffer.hpp"
+
+namespace GLOO {
+// Per-instance data for drawing a node's mesh many times with one call.
+// A node with this component is drawn with glDraw*Instanced by its
+// RenderingComponent and needs a shader that reads the instance attributes,
+// such as InstancedPhongShader.
+class InstancingComponent : public ComponentBase {
+ public:
+  InstancingComponent();
+
+  // position_scales holds the translation in xyz and a uniform scale in w;
+  // rotations holds unit quaternions as (x, y, z, w). Both must have the
+  // same length, which becomes the instance count.
+  void UpdateInstances(const std::vector<glm::vec4>& position_scales,
+                       const std::vector<glm::vec4>& rotations);
+
+  size_t GetInstanceCount() const {
+    return instance_count_;
+  }
+
+  // Attaches the instance buffers to vertex_array at the given attribute
+  // locations, advancing once per instance. Locations of -1 are skipped.
+  void LinkBuffers(const VertexArray& vertex_array,
+                   GLint position_scale_loc,
+                   GLint rotation_loc) const;
+
+ private:
+  using InstanceBuffer = VertexBuffer<glm::vec4, GL_ARRAY_BUFFER>;
+
+  std::unique_ptr<InstanceBuffer> position_scale_buf_;
+  std::unique_ptr<InstanceBuffer> rotation_buf_;
+  size_t instance_count_;
+};
+
+CREATE_COMPONENT_TRAIT(InstancingComponent, ComponentType::Instancing);
+}  // namespace GLOO
+
+#endif
@@ -3,6 +3,9 @@
 #include <stdexcept>
 #include <iostream>
 
+#include "gloo/SceneNode.hpp"
+#include "InstancingComponent.hpp"
+
 namespace GLOO {
 RenderingComponent::RenderingComponent(std::shared_ptr<VertexObject> vertex_obj)
     : vertex_obj_(std::move(vertex_obj)) {
@@ -27,16 +30,29 @@ void RenderingComponent::Render() const {
     throw std::runtime_error(
         "Rendering component has no vertex object attached!");
   }
+  size_t start_index = 0;
+  size_t num_indices;
   if (start_index_ >= 0 && num_indices_ > 0) {
-    vertex_obj_->GetVertexArray().Render(static_cast<size_t>(start_index_),
-                                         static_cast<size_t>(num_indices_));
+    start_index = static_cast<size_t>(start_index_);
+    num_indices = static_cast<size_t>(num_indices_);
+  } else if (vertex_obj_->HasIndices()) {
+    num_indices = vertex_obj_->GetIndices().size();
   } else {
-    if (vertex_obj_->HasIndices())
-      vertex_obj_->GetVertexArray().Render(0, vertex_obj_->GetIndices().size());
-    else
-      vertex_obj_->GetVertexArray().Render(0,
-                                           vertex_obj_->GetPositions().size());
+    num_indices = vertex_obj_->GetPositions().size();
+  }
+
+  // Nodes carrying instance data are drawn once per instance in one call.
+  auto instancing_ptr = node_ptr_ == nullptr
+                            ? nullptr
+                            : node_ptr_->GetComponentPtr<InstancingComponent>();
+  if (instancing_ptr != nullptr) {
+    if (instancing_ptr->GetInstanceCount() > 0) {
+      vertex_obj_->GetVertexArray().RenderInstanced(
+          start_index, num_indices, instancing_ptr->GetInstanceCount());
+    }
+    return;
   }
+  vertex_obj_->GetVertexArray().Render(start_index, num_indices);
 }
 
 void RenderingComponent::SetDrawMode(DrawMode mode) {
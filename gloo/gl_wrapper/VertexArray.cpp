@@ -126,6 +126,18 @@ void VertexArray::LinkTexCoordBuffer(GLuint attr_idx) const {
   GL_CHECK(glEnableVertexAttribArray(attr_idx));
 }
 
+void VertexArray::LinkInstanceBuffer(const BindableBuffer& buffer,
+                                     GLuint attr_idx,
+                                     GLint num_components) const {
+  BindGuard vao_bg(this);
+  BindGuard buf_bg(&buffer);
+  GL_CHECK(glVertexAttribPointer(attr_idx, num_components, GL_FLOAT, GL_FALSE,
+                                 0, 0));
+  GL_CHECK(glEnableVertexAttribArray(attr_idx));
+  // Advance this attribute once per instance instead of once per vertex.
+  GL_CHECK(glVertexAttribDivisor(attr_idx, 1));
+}
+
 void VertexArray::SetDrawMode(DrawMode mode) {
   draw_mode_ = mode;
 }
@@ -157,6 +169,31 @@ void VertexArray::Render(size_t start_index, size_t num_indices) const {
   }
 }
 
+void VertexArray::RenderInstanced(size_t start_index,
+                                  size_t num_indices,
+                                  size_t num_instances) const {
+  BindGuard vao_bg(this);
+
+  if (polygon_mode_ == PolygonMode::Wireframe) {
+    GL_CHECK(glPolygonMode(GL_FRONT_AND_BACK, GL_LINE));
+  } else {
+    GL_CHECK(glPolygonMode(GL_FRONT_AND_BACK, GL_FILL));
+  }
+
+  GLint draw_mode = draw_mode_ == DrawMode::Triangles ? GL_TRIANGLES : GL_LINES;
+
+  if (idx_buf_ != nullptr) {
+    GL_CHECK(glDrawElementsInstanced(
+        draw_mode, static_cast<GLsizei>(num_indices), GL_UNSIGNED_INT,
+        reinterpret_cast<void*>(start_index * sizeof(unsigned int)),
+        static_cast<GLsizei>(num_instances)));
+  } else {
+    GL_CHECK(glDrawArraysInstanced(draw_mode, (GLint)start_index,
+                                   (GLsizei)num_indices,
+                                   static_cast<GLsizei>(num_instances)));
+  }
+}
+
 void VertexArray::Render() const {
   if (idx_buf_ != nullptr)
     Render(0, idx_buf_->GetSize());
@@ -41,6 +41,11 @@ class VertexArray : public IBindable {
   void LinkNormalBuffer(GLuint attr_idx) const;
   void LinkColorBuffer(GLuint attr_idx) const;
   void LinkTexCoordBuffer(GLuint attr_idx) const;
+  // Attaches an externally owned buffer of num_components floats per
+  // instance (attribute divisor 1).
+  void LinkInstanceBuffer(const BindableBuffer& buffer,
+                          GLuint attr_idx,
+                          GLint num_components) const;
 
   bool HasPositionBuffer() const {
     return pos_buf_ != nullptr;
@@ -66,6 +71,10 @@ class VertexArray : public IBindable {
   void SetPolygonMode(PolygonMode mode);
   void Render(size_t start_index, size_t num_indices) const;
   void Render() const;
+  // Draws num_instances copies of the given range in one call.
+  void RenderInstanced(size_t start_index,
+                       size_t num_indices,
+                       size_t num_instances) const;
 
  private:
   // Buffers are invisible to the outside.
@@ -0,0 +1,32 @@
+#include "InstancedPhongShader.hpp"
+
+#include <stdexcept>
+
+#include "gloo/components/InstancingComponent.hpp"
+#include "gloo/components/RenderingComponent.hpp"
+#include "gloo/SceneNode.hpp"
+
+namespace GLOO {
+InstancedPhongShader::InstancedPhongShader()
+    : PhongShader("phong_instanced.vert") {
+  instance_position_scale_loc_ =
+      GetAttributeLocation("instance_position_scale");
+  instance_rotation_loc_ = GetAttributeLocation("instance_rotation");
+}
+
+void InstancedPhongShader::SetTargetNode(const SceneNode& node,
+                                         const glm::mat4& model_matrix) const {
+  PhongShader::SetTargetNode(node, model_matrix);
+
+  auto instancing_ptr = node.GetComponentPtr<InstancingComponent>();
+  if (instancing_ptr == nullptr) {
+    throw std::runtime_error(
+        "Instanced phong shader requires an instancing component!");
+  }
+  instancing_ptr->LinkBuffers(node.GetComponentPtr<RenderingComponent>()
+                                  ->GetVertexObjectPtr()
+                                  ->GetVertexArray(),
+                              instance_position_scale_loc_,
+                              instance_rotation_loc_);
+}
+}  // namespace GLOO
@@ -0,0 +1,21 @@
+#ifndef GLOO_INSTANCED_PHONG_SHADER_H_
+#define GLOO_INSTANCED_PHONG_SHADER_H_
+
+#include "PhongShader.hpp"
+
+namespace GLOO {
+// Phong shading for nodes with an InstancingComponent: each instance is
+// rotated, scaled and translated in the vertex stage before the node's own
+// model matrix is applied.
+class InstancedPhongShader : public PhongShader {
+ public:
+  InstancedPhongShader();
+  void SetTargetNode(const SceneNode& node,
+                     const glm::mat4& model_matrix) const override;
+
+ private:
+  GLint instance_position_scale_loc_, instance_rotation_loc_;
+};
+}  // namespace GLOO
+
+#endif
@@ -15,10 +15,42 @@
 #include "gloo/lights/DirectionalLight.hpp"
 
 namespace GLOO {
-PhongShader::PhongShader()
+PhongShader::PhongShader() : PhongShader("phong.vert") {
+}
+
+PhongShader::PhongShader(const std::string& vertex_shader)
     : ShaderProgram(std::unordered_map<GLenum, std::string>{
-          {GL_VERTEX_SHADER, "phong.vert"},
+          {GL_VERTEX_SHADER, vertex_shader},
           {GL_FRAGMENT_SHADER, "phong.frag"}}) {
+  uniforms_.model_matrix = GetUniformLocation("model_matrix");
+  uniforms_.normal_matrix = GetUniformLocation("normal_matrix");
+  uniforms_.view_matrix = GetUniformLocation("view_matrix");
+  uniforms_.projection_matrix = GetUniformLocation("projection_matrix");
+  uniforms_.camera_position = GetUniformLocation("camera_position");
+  uniforms_.material_ambient = GetUniformLocation("material.ambient");
+  uniforms_.material_diffuse = GetUniformLocation("material.diffuse");
+  uniforms_.material_specular = GetUniformLocation("material.specular");
+  uniforms_.material_shininess = GetUniformLocation("material.shininess");
+  uniforms_.ambient_light_enabled = GetUniformLocation("ambient_light.enabled");
+  uniforms_.ambient_light_ambient = GetUniformLocation("ambient_light.ambient");
+  uniforms_.point_light_enabled = GetUniformLocation("point_light.enabled");
+  uniforms_.point_light_position = GetUniformLocation("point_light.position");
+  uniforms_.point_light_diffuse = GetUniformLocation("point_light.diffuse");
+  uniforms_.point_light_specular = GetUniformLocation("point_light.specular");
+  uniforms_.point_light_attenuation =
+      GetUniformLocation("point_light.attenuation");
+  uniforms_.directional_light_enabled =
+      GetUniformLocation("directional_light.enabled");
+  uniforms_.directional_light_direction =
+      GetUniformLocation("directional_light.direction");
+  uniforms_.directional_light_diffuse =
+      GetUniformLocation("directional_light.diffuse");
+  uniforms_.directional_light_specular =
+      GetUniformLocation("directional_light.specular");
+
+  vertex_position_loc_ = GetAttributeLocation("vertex_position");
+  vertex_normal_loc_ = GetAttributeLocation("vertex_normal");
+  vertex_tex_coord_loc_ = GetAttributeLocation("vertex_tex_coord");
 }
 
 void PhongShader::AssociateVertexArray(VertexArray& vertex_array) const {
@@ -28,13 +60,10 @@ void PhongShader::AssociateVertexArray(VertexArray& vertex_array) const {
   if (!vertex_array.HasNormalBuffer()) {
     throw std::runtime_error("Phong shader requires vertex normals!");
   }
-  vertex_array.LinkPositionBuffer(GetAttributeLocation("vertex_position"));
-  vertex_array.LinkNormalBuffer(GetAttributeLocation("vertex_normal"));
-  if (vertex_array.HasTexCoordBuffer()) {
-    GLint loc = GetAttributeLocation("vertex_tex_coord");
-    if (loc != -1) {
-      vertex_array.LinkTexCoordBuffer(loc);
-    }
+  vertex_array.LinkPositionBuffer(vertex_position_loc_);
+  vertex_array.LinkNormalBuffer(vertex_normal_loc_);
+  if (vertex_array.HasTexCoordBuffer() && vertex_tex_coord_loc_ != -1) {
+    vertex_array.LinkTexCoordBuffer(vertex_tex_coord_loc_);
   }
 }
 
@@ -48,8 +77,8 @@ void PhongShader::SetTargetNode(const SceneNode& node,
   // Set transform.
   glm::mat3 normal_matrix =
       glm::transpose(glm::inverse(glm::mat3(model_matrix)));
-  SetUniform("model_matrix", model_matrix);
-  SetUniform("normal_matrix", normal_matrix);
+  SetUniform(uniforms_.model_matrix, model_matrix);
+  SetUniform(uniforms_.normal_matrix, normal_matrix);
 
   // Set material.
   MaterialComponent* material_component_ptr =
@@ -60,17 +89,17 @@ void PhongShader::SetTargetNode(const SceneNode& node,
   } else {
     material_ptr = &material_component_ptr->GetMaterial();
   }
-  SetUniform("material.ambient", material_ptr->GetAmbientColor());
-  SetUniform("material.diffuse", material_ptr->GetDiffuseColor());
-  SetUniform("material.specular", material_ptr->GetSpecularColor());
-  SetUniform("material.shininess", material_ptr->GetShininess());
+  SetUniform(uniforms_.material_ambient, material_ptr->GetAmbientColor());
+  SetUniform(uniforms_.material_diffuse, material_ptr->GetDiffuseColor());
+  SetUniform(uniforms_.material_specular, material_ptr->GetSpecularColor());
+  SetUniform(uniforms_.material_shininess, material_ptr->GetShininess());
 
 }
 
 void PhongShader::SetCamera(const CameraComponent& camera) const {
-  SetUniform("view_matrix", camera.GetViewMatrix());
-  SetUniform("projection_matrix", camera.GetProjectionMatrix());
-  SetUniform("camera_position",
+  SetUniform(uniforms_.view_matrix, camera.GetViewMatrix());
+  SetUniform(uniforms_.projection_matrix, camera.GetProjectionMatrix());
+  SetUniform(uniforms_.camera_position,
              camera.GetNodePtr()->GetTransform().GetWorldPosition());
 }
 
@@ -82,30 +111,34 @@ void PhongShader::SetLightSource(const LightComponent& component) const {
 
   // First disable all lights.
   // In a single rendering pass, only one light of one type is enabled.
-  SetUniform("ambient_light.enabled", false);
-  SetUniform("point_light.enabled", false);
-  SetUniform("directional_light.enabled", false);
+  SetUniform(uniforms_.ambient_light_enabled, false);
+  SetUniform(uniforms_.point_light_enabled, false);
+  SetUniform(uniforms_.directional_light_enabled, false);
 
   if (light_ptr->GetType() == LightType::Ambient) {
     auto ambient_light_ptr = static_cast<AmbientLight*>(light_ptr);
-    SetUniform("ambient_light.enabled", true);
-    SetUniform("ambient_light.ambient", ambient_light_ptr->GetAmbientColor());
+    SetUniform(uniforms_.ambient_light_enabled, true);
+    SetUniform(uniforms_.ambient_light_ambient,
+               ambient_light_ptr->GetAmbientColor());
   } else if (light_ptr->GetType() == LightType::Point) {
     auto point_light_ptr = static_cast<PointLight*>(light_ptr);
-    SetUniform("point_light.enabled", true);
-    SetUniform("point_light.position",
+    SetUniform(uniforms_.point_light_enabled, true);
+    SetUniform(uniforms_.point_light_position,
                component.GetNodePtr()->GetTransform().GetPosition());
-    SetUniform("point_light.diffuse", point_light_ptr->GetDiffuseColor());
-    SetUniform("point_light.specular", point_light_ptr->GetSpecularColor());
-    SetUniform("point_light.attenuation", point_light_ptr->GetAttenuation());
+    SetUniform(uniforms_.point_light_diffuse,
+               point_light_ptr->GetDiffuseColor());
+    SetUniform(uniforms_.point_light_specular,
+               point_light_ptr->GetSpecularColor());
+    SetUniform(uniforms_.point_light_attenuation,
+               point_light_ptr->GetAttenuation());
   } else if (light_ptr->GetType() == LightType::Directional) {
     auto directional_light_ptr = static_cast<DirectionalLight*>(light_ptr);
-    SetUniform("directional_light.enabled", true);
-    SetUniform("directional_light.direction",
+    SetUniform(uniforms_.directional_light_enabled, true);
+    SetUniform(uniforms_.directional_light_direction,
                directional_light_ptr->GetDirection());
-    SetUniform("directional_light.diffuse",
+    SetUniform(uniforms_.directional_light_diffuse,
                directional_light_ptr->GetDiffuseColor());
-    SetUniform("directional_light.specular",
+    SetUniform(uniforms_.directional_light_specular,
                directional_light_ptr->GetSpecularColor());
   } else {
     throw std::runtime_error(
@@ -12,9 +12,27 @@ class PhongShader : public ShaderProgram {
   void SetCamera(const CameraComponent& camera) const override;
   void SetLightSource(const LightComponent& componentt) const override;
 
+ protected:
+  // For variants that swap in a different vertex stage over phong.frag.
+  explicit PhongShader(const std::string& vertex_shader);
 
  private:
   void AssociateVertexArray(VertexArray& vertex_array) const;
+
+  // Locations resolved once after linking; Set* runs per node per pass.
+  struct UniformLocations {
+    GLint model_matrix, normal_matrix, view_matrix, projection_matrix;
+    GLint camera_position;
+    GLint material_ambient, material_diffuse, material_specular,
+        material_shininess;
+    GLint ambient_light_enabled, ambient_light_ambient;
+    GLint point_light_enabled, point_light_position, point_light_diffuse,
+        point_light_specular, point_light_attenuation;
+    GLint directional_light_enabled, directional_light_direction,
+        directional_light_diffuse, directional_light_specular;
+  };
+  UniformLocations uniforms_;
+  GLint vertex_position_loc_, vertex_normal_loc_, vertex_tex_coord_loc_;
 };
 }  // namespace GLOO
 
@@ -1,10 +1,12 @@
 #include "ShaderProgram.hpp"
 
+#include <algorithm>
 #include <iterator>
 #include <stdexcept>
 #include <unordered_map>
 #include <iostream>
 #include <fstream>
+#include <vector>
 
 #include <glm/gtc/type_ptr.hpp>
 
@@ -46,6 +48,52 @@ ShaderProgram::ShaderProgram(
     GL_CHECK(glDetachShader(shader_program_, handle));
     GL_CHECK(glDeleteShader(handle));
   }
+
+  CacheLocations();
+}
+
+void ShaderProgram::CacheLocations() {
+  GLint max_name_length = 0;
+  GL_CHECK(glGetProgramiv(shader_program_, GL_ACTIVE_UNIFORM_MAX_LENGTH,
+                          &max_name_length));
+  GLint attribute_max_name_length = 0;
+  GL_CHECK(glGetProgramiv(shader_program_, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH,
+                          &attribute_max_name_length));
+  std::vector<GLchar> name_buf(
+      std::max(max_name_length, attribute_max_name_length) + 1);
+
+  GLint num_uniforms = 0;
+  GL_CHECK(glGetProgramiv(shader_program_, GL_ACTIVE_UNIFORMS, &num_uniforms));
+  for (GLint i = 0; i < num_uniforms; i++) {
+    GLsizei length;
+    GLint size;
+    GLenum type;
+    GL_CHECK(glGetActiveUniform(shader_program_, i, (GLsizei)name_buf.size(),
+                                &length, &size, &type, name_buf.data()));
+    std::string name(name_buf.data(), length);
+    GLint loc = glGetUniformLocation(shader_program_, name.c_str());
+    GL_CHECK_ERROR();
+    uniform_locations_[name] = loc;
+    // Arrays are reported as "name[0]" but may be set as "name".
+    if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0) {
+      uniform_locations_[name.substr(0, name.size() - 3)] = loc;
+    }
+  }
+
+  GLint num_attributes = 0;
+  GL_CHECK(
+      glGetProgramiv(shader_program_, GL_ACTIVE_ATTRIBUTES, &num_attributes));
+  for (GLint i = 0; i < num_attributes; i++) {
+    GLsizei length;
+    GLint size;
+    GLenum type;
+    GL_CHECK(glGetActiveAttrib(shader_program_, i, (GLsizei)name_buf.size(),
+                               &length, &size, &type, name_buf.data()));
+    std::string name(name_buf.data(), length);
+    GLint loc = glGetAttribLocation(shader_program_, name.c_str());
+    GL_CHECK_ERROR();
+    attribute_locations_[name] = loc;
+  }
 }
 
 ShaderProgram::~ShaderProgram() {
@@ -61,9 +109,13 @@ void ShaderProgram::Unbind() const {
 }
 
 GLint ShaderProgram::GetAttributeLocation(const std::string& name) const {
-  GLint loc = glGetAttribLocation(shader_program_, name.c_str());
-  GL_CHECK_ERROR();
-  return loc;
+  auto itr = attribute_locations_.find(name);
+  return itr == attribute_locations_.end() ? -1 : itr->second;
+}
+
+GLint ShaderProgram::GetUniformLocation(const std::string& name) const {
+  auto itr = uniform_locations_.find(name);
+  return itr == uniform_locations_.end() ? -1 : itr->second;
 }
 
 GLuint ShaderProgram::LoadShader(GLenum type,
@@ -101,34 +153,44 @@ GLuint ShaderProgram::LoadShader(GLenum type,
 
 void ShaderProgram::SetUniform(const std::string& name,
                                const glm::mat4& value) const {
-  GLint loc = glGetUniformLocation(shader_program_, name.c_str());
-  GL_CHECK_ERROR();
-  GL_CHECK(glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(value)));
+  SetUniform(GetUniformLocation(name), value);
 }
 
 void ShaderProgram::SetUniform(const std::string& name,
                                const glm::mat3& value) const {
-  GLint loc = glGetUniformLocation(shader_program_, name.c_str());
-  GL_CHECK_ERROR();
-  GL_CHECK(glUniformMatrix3fv(loc, 1, GL_FALSE, glm::value_ptr(value)));
+  SetUniform(GetUniformLocation(name), value);
 }
 
 void ShaderProgram::SetUniform(const std::string& name,
                                const glm::vec3& value) const {
-  GLint loc = glGetUniformLocation(shader_program_, name.c_str());
-  GL_CHECK_ERROR();
-  GL_CHECK(glUniform3fv(loc, 1, glm::value_ptr(value)));
+  SetUniform(GetUniformLocation(name), value);
 }
 
 void ShaderProgram::SetUniform(const std::string& name, float value) const {
-  GLint loc = glGetUniformLocation(shader_program_, name.c_str());
-  GL_CHECK_ERROR();
-  GL_CHECK(glUniform1f(loc, value));
+  SetUniform(GetUniformLocation(name), value);
 }
 
 void ShaderProgram::SetUniform(const std::string& name, int value) const {
-  GLint loc = glGetUniformLocation(shader_program_, name.c_str());
-  GL_CHECK_ERROR();
-  GL_CHECK(glUniform1i(loc, value));
+  SetUniform(GetUniformLocation(name), value);
+}
+
+void ShaderProgram::SetUniform(GLint location, const glm::mat4& value) const {
+  GL_CHECK(glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value)));
+}
+
+void ShaderProgram::SetUniform(GLint location, const glm::mat3& value) const {
+  GL_CHECK(glUniformMatrix3fv(location, 1, GL_FALSE, glm::value_ptr(value)));
+}
+
+void ShaderProgram::SetUniform(GLint location, const glm::vec3& value) const {
+  GL_CHECK(glUniform3fv(location, 1, glm::value_ptr(value)));
+}
+
+void ShaderProgram::SetUniform(GLint location, float value) const {
+  GL_CHECK(glUniform1f(location, value));
+}
+
+void ShaderProgram::SetUniform(GLint location, int value) const {
+  GL_CHECK(glUniform1i(location, value));
 }
 }  // namespace GLOO
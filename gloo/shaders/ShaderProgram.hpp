@@ -23,7 +23,11 @@ class ShaderProgram : public IBindable {
   virtual ~ShaderProgram();
   void Bind() const override;
   void Unbind() const override;
+  // Both lookups go through the tables filled in after linking and return -1
+  // for names the program does not use, like their glGet*Location
+  // counterparts.
   GLint GetAttributeLocation(const std::string& name) const;
+  GLint GetUniformLocation(const std::string& name) const;
 
   // The following Set* methods are called by the renderer, thus const.
   virtual void SetTargetNode(const SceneNode& node,
@@ -41,8 +45,17 @@ class ShaderProgram : public IBindable {
   void SetUniform(const std::string& name, const glm::vec3& value) const;
   void SetUniform(const std::string& name, float value) const;
   void SetUniform(const std::string& name, int value) const;
+  // Handle-based variants for locations resolved once with
+  // GetUniformLocation; these never touch strings.
+  void SetUniform(GLint location, const glm::mat4& value) const;
+  void SetUniform(GLint location, const glm::mat3& value) const;
+  void SetUniform(GLint location, const glm::vec3& value) const;
+  void SetUniform(GLint location, float value) const;
+  void SetUniform(GLint location, int value) const;
 
  private:
+  // Records the location of every active uniform and attribute.
+  void CacheLocations();
   static GLuint LoadShader(GLenum type,
                            std::string shader_code,
                            const std::string& shader_filename);
@@ -51,6 +64,8 @@ class ShaderProgram : public IBindable {
 
   std::unordered_map<GLenum, GLuint> shader_handles_;
   GLuint shader_program_;
+  std::unordered_map<std::string, GLint> uniform_locations_;
+  std::unordered_map<std::string, GLint> attribute_locations_;
 };
 }  // namespace GLOO
 
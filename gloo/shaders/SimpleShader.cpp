@@ -18,13 +18,18 @@ SimpleShader::SimpleShader()
     : ShaderProgram(std::unordered_map<GLenum, std::string>(
           {{GL_VERTEX_SHADER, "simple.vert"},
            {GL_FRAGMENT_SHADER, "simple.frag"}})) {
+  model_matrix_loc_ = GetUniformLocation("model_matrix");
+  view_matrix_loc_ = GetUniformLocation("view_matrix");
+  projection_matrix_loc_ = GetUniformLocation("projection_matrix");
+  material_color_loc_ = GetUniformLocation("material_color");
+  vertex_position_loc_ = GetAttributeLocation("vertex_position");
 }
 
 void SimpleShader::AssociateVertexArray(VertexArray& vertex_array) const {
   if (!vertex_array.HasPositionBuffer()) {
     throw std::runtime_error("Simple shader requires vertex positions!");
   }
-  vertex_array.LinkPositionBuffer(GetAttributeLocation("vertex_position"));
+  vertex_array.LinkPositionBuffer(vertex_position_loc_);
 }
 
 void SimpleShader::SetTargetNode(const SceneNode& node,
@@ -35,23 +40,23 @@ void SimpleShader::SetTargetNode(const SceneNode& node,
                            ->GetVertexArray());
 
   // Set transform.
-  SetUniform("model_matrix", model_matrix);
+  SetUniform(model_matrix_loc_, model_matrix);
 
   // Set material.
   MaterialComponent* material_component_ptr =
       node.GetComponentPtr<MaterialComponent>();
   if (material_component_ptr == nullptr) {
     // Default material: greenish.
-    SetUniform("material_color", glm::vec3(0.0f, 0.7f, 0.2f));
+    SetUniform(material_color_loc_, glm::vec3(0.0f, 0.7f, 0.2f));
   } else {
-    SetUniform("material_color",
+    SetUniform(material_color_loc_,
                material_component_ptr->GetMaterial().GetDiffuseColor());
   }
 }
 
 void SimpleShader::SetCamera(const CameraComponent& camera) const {
-  SetUniform("view_matrix", camera.GetViewMatrix());
-  SetUniform("projection_matrix", camera.GetProjectionMatrix());
+  SetUniform(view_matrix_loc_, camera.GetViewMatrix());
+  SetUniform(projection_matrix_loc_, camera.GetProjectionMatrix());
 }
 
 }  // namespace GLOO
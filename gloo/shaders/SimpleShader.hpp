@@ -14,6 +14,10 @@ class SimpleShader : public ShaderProgram {
 
  private:
   void AssociateVertexArray(VertexArray& vertex_array) const;
+
+  GLint model_matrix_loc_, view_matrix_loc_, projection_matrix_loc_;
+  GLint material_color_loc_;
+  GLint vertex_position_loc_;
 };
 }  // namespace GLOO
 
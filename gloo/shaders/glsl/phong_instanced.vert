@@ -0,0 +1,33 @@
+#version 330 core
+
+uniform mat4 model_matrix;
+uniform mat3 normal_matrix;
+uniform mat4 view_matrix;
+uniform mat4 projection_matrix;
+
+layout(location = 0) in vec3 vertex_position;
+layout(location = 1) in vec3 vertex_normal;
+layout(location = 2) in vec2 vertex_tex_coord;
+
+// Per-instance attributes: translation with uniform scale in w, and the
+// rotation as a unit quaternion (x, y, z, w).
+layout(location = 3) in vec4 instance_position_scale;
+layout(location = 4) in vec4 instance_rotation;
+
+out vec3 world_position;
+out vec3 world_normal;
+out vec2 tex_coord;
+
+vec3 Rotate(vec4 q, vec3 v) {
+    return v + 2.0 * cross(q.xyz, cross(q.xyz, v) + q.w * v);
+}
+
+void main() {
+    vec3 instance_position = Rotate(instance_rotation,
+        vertex_position * instance_position_scale.w) + instance_position_scale.xyz;
+    world_position = vec3(model_matrix * vec4(instance_position, 1.0));
+    world_normal = normal_matrix * Rotate(instance_rotation, vertex_normal);
+
+    tex_coord = vertex_tex_coord;
+    gl_Position = projection_matrix * view_matrix * vec4(world_position, 1.0);
+}
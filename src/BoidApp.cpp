@@ -1,5 +1,9 @@
 #include "BoidApp.hpp"
 
+#include <thread>
+#include <iostream>
+#include <algorithm>
+
 #include <glm/gtx/string_cast.hpp>
 #include <glm/ext/matrix_transform.hpp>
 
@@ -19,6 +23,7 @@
 #include "gloo/debug/PrimitiveFactory.hpp"
 #include "FlockNode.hpp"
 #include "FlockNode.hpp"
+#include "sim/Profiler.hpp"
 
 namespace {
     const std::vector<std::string> parameterNames = {"close range", "visible range", "visible angle", "alignment strength", "cohesion strength", "separation strength", "max speed", "max force", "predator avoidance"};
@@ -26,8 +31,8 @@ namespace {
 
 namespace GLOO {
 BoidApp::BoidApp(const std::string& app_name,
-                                 glm::ivec2 window_size)
-    : Application(app_name, window_size){
+                                 glm::ivec2 window_size, bool visible)
+    : Application(app_name, window_size, visible){
 }
 
 void BoidApp::SetupScene() {
@@ -57,7 +62,8 @@ void BoidApp::SetupScene() {
 
     auto flock_node = make_unique<FlockNode>();
     flock_ptr_ = flock_node.get();
-    SetupBoundaries(flock_node->lower_bounds_ - glm::vec3(flock_node->margin_), flock_node->upper_bounds_ + glm::vec3(flock_node->margin_));
+    const FlockSimulation& sim = flock_node->get_simulation();
+    SetupBoundaries(sim.lower_bounds_ - glm::vec3(sim.margin_), sim.upper_bounds_ + glm::vec3(sim.margin_));
     root.AddChild(std::move(flock_node));
 }
 
@@ -135,15 +141,175 @@ void BoidApp::SetupBoundaries(glm::vec3 lower_bounds, glm::vec3 upper_bounds) {
 }
 
 void BoidApp::DrawGUI() {
+    FlockSimulation& sim = flock_ptr_->get_simulation();
     bool modified = false;
     ImGui::Begin("Control Panel");
     for (size_t i = 0; i < parameterNames.size(); i++) {
         ImGui::Text("%s", parameterNames[i].c_str());
         ImGui::PushID((int)i);
-        modified |= ImGui::SliderFloat("", &flock_ptr_->params_[i], min_values_[i], max_values_[i]);
+        modified |= ImGui::SliderFloat("", &sim.params_[i], min_values_[i], max_values_[i]);
         ImGui::PopID();
     }
+    int index_type = static_cast<int>(sim.index_type_);
+    ImGui::Text("neighbor index");
+    if (ImGui::Combo("##index", &index_type, "quadtree\0uniform grid\0linear octree\0incremental grid\0")) {
+        sim.index_type_ = static_cast<SpatialIndexType>(index_type);
+    }
+    int kernel = static_cast<int>(sim.steering_kernel_);
+    ImGui::Text("steering kernel");
+    if (ImGui::Combo("##kernel", &kernel, "neighbor lists\0scalar\0sse\0avx2\0")) {
+        if (steering_kernel_supported(static_cast<SteeringKernel>(kernel))) {
+            sim.steering_kernel_ = static_cast<SteeringKernel>(kernel);
+        }
+    }
+    int thread_count = static_cast<int>(sim.get_thread_count());
+    if (sim.index_type_ == SpatialIndexType::IncrementalGrid) {
+        ImGui::Text("rebuild when more than this fraction moved");
+        ImGui::SliderFloat("##rebuild", &sim.rebuild_fraction_, 0.f, 1.f);
+    }
+    ImGui::Text("simulation threads");
+    int max_threads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    if (ImGui::SliderInt("##threads", &thread_count, 1, max_threads)) {
+        sim.set_thread_count(static_cast<unsigned>(thread_count));
+    }
+    ImGui::Text("topological neighbors (0: all in range)");
+    ImGui::SliderInt("##topological", &sim.topological_neighbors_, 0, 32);
+    ImGui::Checkbox("verlet neighbor lists", &sim.verlet_lists_);
+    if (sim.verlet_lists_) {
+        ImGui::Text("skin distance");
+        ImGui::SliderFloat("##skin", &sim.verlet_skin_, 0.f, 2.f);
+    }
+    ImGui::Text("Morton reorder every N steps (0: off)");
+    ImGui::SliderInt("##reorder", &sim.reorder_interval_, 0, 60);
+    ImGui::Checkbox("deterministic (sum neighbors in id order)", &sim.deterministic_);
+    ImGui::Text("simulation steps per second");
+    ImGui::SliderFloat("##steps", &sim.steps_per_second_, 10.f, 240.f);
+    ImGui::Checkbox("neighbor stats", &sim.collect_stats_);
+    if (sim.collect_stats_) {
+        const StepStats& stats = sim.get_last_stats();
+        ImGui::Text("close: avg %.2f max %d", stats.avg_close_neighbors, stats.max_close_neighbors);
+        ImGui::Text("visible: avg %.2f max %d", stats.avg_visible_neighbors, stats.max_visible_neighbors);
+        ImGui::Text("index: %.2f ms build, %zu nodes", stats.index_build_ms, stats.index_node_count);
+        if (sim.verlet_lists_) {
+            ImGui::Text("neighbor lists: %zu entries%s", stats.neighbor_list_entries,
+                        stats.neighbor_lists_rebuilt ? " (rebuilt)" : "");
+        }
+        if (sim.index_type_ == SpatialIndexType::IncrementalGrid) {
+            ImGui::Text("relocated: %zu of %zu boids%s", stats.index_relocations, sim.size(),
+                        stats.index_rebuilt ? " (rebuilt)" : "");
+        }
+    }
+    bool instanced = flock_ptr_->get_instanced_rendering();
+    if (ImGui::Checkbox("instanced rendering", &instanced)) {
+        flock_ptr_->set_instanced_rendering(instanced);
+    }
+    ImGui::Separator();
+    if (ImGui::Button("save snapshot") && !flock_ptr_->save_snapshot(snapshot_path_)) {
+        std::cerr << "Could not write snapshot to " << snapshot_path_ << std::endl;
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("restore snapshot") && !flock_ptr_->restore_snapshot(snapshot_path_)) {
+        std::cerr << "Could not restore " << snapshot_path_ << std::endl;
+    }
+    if (flock_ptr_->is_replaying()) {
+        ImGui::Separator();
+        ImGui::Text("replaying %zu frames", flock_ptr_->get_replay_frame_count());
+        int frame = static_cast<int>(flock_ptr_->get_replay_position());
+        int last = static_cast<int>(flock_ptr_->get_replay_frame_count()) - 1;
+        if (ImGui::SliderInt("##frame", &frame, 0, last)) {
+            flock_ptr_->seek_replay(frame);
+        }
+        ImGui::Checkbox("paused", &flock_ptr_->replay_paused_);
+        if (ImGui::Button("back to simulation")) {
+            flock_ptr_->stop_replay();
+        }
+    } else {
+        bool recording = flock_ptr_->is_recording();
+        if (ImGui::Checkbox("record trajectory", &recording)) {
+            if (recording && !flock_ptr_->start_recording(trajectory_path_)) {
+                std::cerr << "Could not write trajectory to " << trajectory_path_ << std::endl;
+            } else if (!recording) {
+                flock_ptr_->stop_recording();
+            }
+        }
+        if (flock_ptr_->is_recording()) {
+            ImGui::Text("recording to %s", trajectory_path_.c_str());
+        }
+        bool checkpointing = flock_ptr_->is_checkpointing();
+        if (ImGui::Checkbox("write checkpoints", &checkpointing)) {
+            if (checkpointing && !flock_ptr_->start_checkpoints(checkpoint_path_, checkpoint_interval_,
+                                                                lossless_checkpoints_ ? CheckpointMode::Lossless
+                                                                                      : CheckpointMode::Quantized)) {
+                std::cerr << "Could not write checkpoints to " << checkpoint_path_ << std::endl;
+            } else if (!checkpointing) {
+                flock_ptr_->stop_checkpoints();
+            }
+        }
+        if (flock_ptr_->is_checkpointing()) {
+            const CheckpointWriter& writer = flock_ptr_->get_checkpoint_writer();
+            ImGui::Text("%zu written (%.1f MB), %zu skipped", writer.get_written(),
+                        writer.get_bytes_written() / 1e6, writer.get_dropped());
+        } else {
+            ImGui::Text("checkpoint every N steps");
+            ImGui::SliderInt("##checkpoint", &checkpoint_interval_, 1, 600);
+            ImGui::Checkbox("lossless checkpoints", &lossless_checkpoints_);
+        }
+    }
+    ImGui::End();
+
+#ifdef BOIDS_PROFILING
+    TraceWriter& trace = TraceWriter::instance();
+    bool recording = trace.is_recording();
+    if (ImGui::IsKeyPressed(GLFW_KEY_F9, false)) {
+        recording = !recording;
+    }
+
+    // Times over the profiler history; the current frame is still open, so
+    // this shows up to the previous one.
+    const Profiler& profiler = Profiler::instance();
+    ImGui::Begin("Profiler");
+    ImGui::Text("last %zu frames", std::min(static_cast<size_t>(profiler.get_frame_count()), Profiler::kHistoryFrames));
+    ImGui::Columns(4, "zones");
+    ImGui::Text("zone");
+    ImGui::NextColumn();
+    ImGui::Text("min ms");
+    ImGui::NextColumn();
+    ImGui::Text("avg ms");
+    ImGui::NextColumn();
+    ImGui::Text("p99 ms");
+    ImGui::NextColumn();
+    ImGui::Separator();
+    for (size_t i = 0; i < profiler.zone_count(); i++) {
+        const Profiler::Zone& zone = profiler.zone(i);
+        Profiler::ZoneStats stats = profiler.stats(i);
+        ImGui::Text("%*s%s", 2 * zone.depth, "", zone.name.c_str());
+        ImGui::NextColumn();
+        ImGui::Text("%.3f", stats.min_ms);
+        ImGui::NextColumn();
+        ImGui::Text("%.3f", stats.avg_ms);
+        ImGui::NextColumn();
+        ImGui::Text("%.3f", stats.p99_ms);
+        ImGui::NextColumn();
+    }
+    ImGui::Columns(1);
+    ImGui::Separator();
+    ImGui::Checkbox("record trace (F9)", &recording);
+    if (recording != trace.is_recording()) {
+        if (recording) {
+            if (!trace.start(trace_path_)) {
+                std::cerr << "Could not write trace to " << trace_path_ << std::endl;
+            }
+        } else {
+            trace.stop();
+            std::cout << "Trace written to " << trace_path_ << " (" << trace.get_dropped()
+                      << " events dropped)" << std::endl;
+        }
+    }
+    if (trace.is_recording()) {
+        ImGui::Text("recording to %s", trace_path_.c_str());
+    }
     ImGui::End();
+#endif
 
 }
 
@@ -7,9 +7,24 @@
 namespace GLOO {
 class BoidApp : public Application {
     public:
-        BoidApp(const std::string& app_name, glm::ivec2 window_size);
+        BoidApp(const std::string& app_name, glm::ivec2 window_size, bool visible = true);
         void SetupScene() override;
         void SetupBoundaries(glm::vec3 lower_bounds, glm::vec3 upper_bounds);
+        FlockNode* get_flock() {
+            return flock_ptr_;
+        };
+        // File the snapshot buttons save to and restore from.
+        void set_snapshot_path(const std::string& path) {
+            snapshot_path_ = path;
+        };
+        // Where the "record trajectory" checkbox writes to.
+        void set_trajectory_path(const std::string& path) {
+            trajectory_path_ = path;
+        };
+        // Where F9 records a Chrome trace to (profiler builds only).
+        void set_trace_path(const std::string& path) {
+            trace_path_ = path;
+        };
     protected:
         void DrawGUI() override;
 
@@ -17,6 +32,12 @@ class BoidApp : public Application {
         std::vector<float> slider_values_;
         std::vector<float>* slider_values_ptr_;
         FlockNode* flock_ptr_;
+        std::string trace_path_ = "boids_trace.json";
+        std::string trajectory_path_ = "boids.trj";
+        std::string checkpoint_path_ = "boids.ckp";
+        std::string snapshot_path_ = "boids.snap";
+        int checkpoint_interval_ = 60;
+        bool lossless_checkpoints_ = false;
 
         std::vector<float> min_values_ = {
             0.0f, // 0: close range
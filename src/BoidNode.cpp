@@ -0,0 +1,33 @@
+#include "BoidNode.hpp"
+
+namespace GLOO{
+
+void BoidNode::attach_shared_components(std::shared_ptr<VertexObject> mesh) {
+    CreateComponent<ShadingComponent>(ResourceCache::GetInstance().GetShader<PhongShader>());
+    CreateComponent<RenderingComponent>(std::move(mesh));
+    CreateComponent<MaterialComponent>(get_shared_material(predator_));
+}
+
+std::shared_ptr<Material> BoidNode::get_shared_material(bool predator) {
+    static std::shared_ptr<Material> prey_material = [] {
+        std::shared_ptr<Material> mat = std::make_shared<Material>(Material::GetDefault());
+        mat->SetAmbientColor(glm::vec3(1.f));
+        return mat;
+    }();
+    static std::shared_ptr<Material> predator_material = std::make_shared<Material>(Material::GetDefault());
+    return predator ? predator_material : prey_material;
+}
+
+void BoidNode::set_predator(bool predator) {
+    if (predator == predator_) return;
+    predator_ = predator;
+    GetComponentPtr<MaterialComponent>()->SetMaterial(get_shared_material(predator_));
+}
+
+void BoidNode::set_color(const glm::vec3& color) {
+    std::shared_ptr<Material> mat = std::make_shared<Material>(*get_shared_material(predator_));
+    mat->SetAmbientColor(color);
+    mat->SetDiffuseColor(color);
+    GetComponentPtr<MaterialComponent>()->SetMaterial(std::move(mat));
+}
+} // namespace GLOO
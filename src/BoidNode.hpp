@@ -8,82 +8,40 @@
 #include "gloo/components/RenderingComponent.hpp"
 #include "gloo/components/ShadingComponent.hpp"
 #include "gloo/components/MaterialComponent.hpp"
+#include "gloo/ResourceCache.hpp"
 
 #include <string>
 #include <vector>
 
 
 namespace GLOO{
+// Scene-graph proxy for one simulated boid. The simulated quantities live in
+// FlockSimulation's FlockState; FlockNode copies position and heading into
+// this node's transform once per frame.
 class BoidNode : public SceneNode{
     public: 
         BoidNode(bool predator = false){
             glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f);
-            velocity_ = glm::vec3(1.0f, 1.0f, 1.0f);
-            acceleration_ = glm::vec3(1.0f, 0.0f, 0.0f);
             predator_ = predator;
 
-            if (!predator_) {
-                mat_->SetAmbientColor(glm::vec3(1.f));
-            }
-
-            CreateComponent<ShadingComponent>(shader_);
-            CreateComponent<RenderingComponent>(sphere_mesh_);
-            CreateComponent<MaterialComponent>(mat_);
+            attach_shared_components(ResourceCache::GetInstance().GetSphere(0.5f, 25, 25));
 
             this->GetTransform().SetPosition(position);
 
-            close_range_ = 1.5f;
-            visible_range_ = 2.0f;
-            visible_angle_ = 3.14f;
-
             // this->SetActive(false); testing whether render or simulation is bottleneck
 
         }
 
-        BoidNode(float x, float y, float z, float vx, float vy, float vz, float ax, float ay, float az, float close_range, float visible_range, float visible_angle, bool predator = false) : 
-            velocity_(glm::vec3{vx, vy, vz}), acceleration_{ax, ay, az}, close_range_{close_range}, visible_range_    {visible_range}, visible_angle_{visible_angle} {
-            
-            glm::vec3 position = glm::vec3(x, y, z);
+        BoidNode(const glm::vec3& position, bool predator = false) {
             this->GetTransform().SetPosition(position);
             predator_ = predator;
 
-            if (!predator_) {
-                mat_->SetAmbientColor(glm::vec3(1.f));
-            }
-
-            CreateComponent<ShadingComponent>(shader_);
-            // CreateComponent<RenderingComponent>(sphere_mesh_);
-            CreateComponent<RenderingComponent>(cone_mesh_);
-            CreateComponent<MaterialComponent>(mat_);
+            attach_shared_components(ResourceCache::GetInstance().GetCone(0.2f, 0.5f, 25));
             // this->SetActive(false); testing whether render or simulation is bottleneck
 
 
         };
 
-        float get_close_range() const {
-            return close_range_;
-        };
-        
-        float get_visible_range() const {
-            return visible_range_;
-        };
-        
-        float get_visible_angle() const {
-            return visible_angle_;
-        };
-
-        void set_close_range(float close_range) {
-            close_range_ = close_range;
-        };
-        
-        void set_visible_range(float visible_range) {
-            visible_range_ = visible_range;
-        };
-        
-        void set_visible_angle(float visible_angle) {
-            visible_angle_ = visible_angle;
-        };
-        
         glm::quat get_rotation() const {
             return this->GetTransform().GetRotation();
         };
@@ -100,57 +58,37 @@ class BoidNode : public SceneNode{
             return this->GetTransform().GetPosition();
         };
 
-        glm::vec3 get_velocity() const {
-            return velocity_;
-        };
-        
-        glm::vec3 get_acceleration() const {
-            return acceleration_;
-        };
-
         void set_position(const glm::vec3 position){
             this->GetTransform().SetPosition(position);
         };
 
-        void set_velocity(const glm::vec3& vel) {
-            velocity_ = vel;
-        };
-
-        void set_acceleration(const glm::vec3& acc) {
-            acceleration_ = acc;
+        // Position and heading in one transform update.
+        void set_pose(const glm::vec3& position, const glm::quat& rotation) {
+            this->GetTransform().SetPositionAndRotation(position, rotation);
         };
 
         bool is_predator() const {
             return predator_;
         }
+        // Switches to the other kind's shared material; drops a set_color.
+        void set_predator(bool predator);
 
         void set_mesh_scale(float scale) {
             this->GetTransform().SetScale(glm::vec3(scale));
         }
-    private:
-        float close_range_;
-        float visible_range_;
-        float visible_angle_;
-
-        bool predator_ = false;
-
-        glm::vec3 velocity_;
-        glm::vec3 acceleration_;
 
-        float max_speed_ = 1.f;
-        float max_acc_ = 0.05;
+        // Gives this boid its own material in the given color; until then it
+        // shares one material with every other boid of the same kind.
+        void set_color(const glm::vec3& color);
 
-        void time_step(float dt) {
-            glm::vec3 new_vel = velocity_ + acceleration_ * dt;
-            glm::vec3 new_pos = this->get_position() + new_vel * dt;
-            this->set_velocity(new_vel);
-            this->set_position(new_pos);
-        };
+        // Material every boid of the given kind starts out with.
+        static std::shared_ptr<Material> get_shared_material(bool predator);
+    private:
+        // Mesh and shader come from the ResourceCache and the material is
+        // shared per predator/prey, so a boid only owns its transform.
+        void attach_shared_components(std::shared_ptr<VertexObject> mesh);
 
-        std::shared_ptr<VertexObject> sphere_mesh_ = PrimitiveFactory::CreateSphere(0.5f, 25, 25);
-        std::shared_ptr<VertexObject> cone_mesh_ = PrimitiveFactory::CreateCone(0.2f, 0.5f, 25);
-        std::shared_ptr<ShaderProgram> shader_ = std::make_shared<PhongShader>();
-        std::shared_ptr<Material> mat_ = std::make_shared<Material>(Material::GetDefault());
+        bool predator_ = false;
         // heading is just normalized velocity
 };
 } // namespace GLOO
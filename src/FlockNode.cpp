@@ -2,269 +2,369 @@
 #include <vector>
 #include "BoidNode.hpp"
 // #include <glm/glm.hpp>
-#include <random>
 #include <glm/gtx/string_cast.hpp>
 #include <glm/gtx/quaternion.hpp>
 #include <glm/gtc/constants.hpp>
 #include "TestNode.hpp"
-#include <chrono>
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+#include <thread>
 #include "gloo/InputManager.hpp"
+#include "sim/Profiler.hpp"
+#include "gloo/shaders/InstancedPhongShader.hpp"
 
 namespace GLOO{
 
-using clock = std::chrono::high_resolution_clock;
-using time_point = std::chrono::time_point<clock>;
-
-inline time_point now() {
-    return clock::now();
-}
-
-inline double ms(time_point t0, time_point t1) {
-    return std::chrono::duration<double, std::milli>(t1 - t0).count();
-}
+namespace {
+// The live simulation as a Frame for the sync functions.
+struct LiveFrame {
+    const FlockSimulation& sim;
+
+    size_t size() const {
+        return sim.size();
+    };
+    uint32_t id(size_t i) const {
+        return sim.get_state().id[i];
+    };
+    glm::vec3 position(size_t i) const {
+        return sim.get_interpolated_position(i);
+    };
+    glm::vec3 velocity(size_t i) const {
+        return sim.get_state().velocity(i);
+    };
+    bool is_predator(size_t i) const {
+        return sim.get_state().is_predator(i);
+    };
+};
+
+// Two consecutive trajectory frames blended by alpha. Trajectories store
+// boids in id order, so index and id coincide.
+struct ReplayFrame {
+    TrajectoryFrame from;
+    TrajectoryFrame to;
+    float alpha;
+
+    size_t size() const {
+        return to.size();
+    };
+    uint32_t id(size_t i) const {
+        return static_cast<uint32_t>(i);
+    };
+    glm::vec3 position(size_t i) const {
+        return glm::mix(from.position(i), to.position(i), alpha);
+    };
+    glm::vec3 velocity(size_t i) const {
+        return to.velocity(i);
+    };
+    bool is_predator(size_t i) const {
+        return to.is_predator(i);
+    };
+};
+} // namespace
 
 FlockNode::FlockNode(){
     // Default constructor
-    // 50 boids with default parameters and time step size 0.1, normally distributed around (0,0) 
-    // boids_ is a vector of unique_ptrs; start empty
-
-    // debugging rn so only 10
-    time_step_size_ = 0.1f;
-    for (int i = 0; i < 4000; ++i) {
-        std::unique_ptr<BoidNode> temp_boid = make_unique<BoidNode>(dist(rng), dist(rng), dist(rng), 0.01f, 0.01f, 0.01f, 0.0f, 0.0f, 0.f, 1.5f, 5.0f, 3.14f);
-        boids_.push_back(temp_boid.get());
-        AddChild(std::move(temp_boid));
-        // std::cout << "Added boid at" << glm::to_string(boids_.back()->get_position()) << std::endl;
-    }
-    quadtree_ = make_unique<QuadTree>(lower_bounds_, upper_bounds_, 4, boids_);
-
-    std::unique_ptr<BoidNode> temp_predator = make_unique<BoidNode>(dist(rng), dist(rng), dist(rng), 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.f, 5.f, 10.f, 3.14f, true);
-    predator_ = temp_predator.get();
-    predator_->set_mesh_scale(3.0f); // make predator larger
-    boids_.push_back(temp_predator.get());
-    AddChild(std::move(temp_predator));
-
-    for (int i = 0; i < 4; i++) {
-        std::unique_ptr<BoidNode> temp_predator = make_unique<BoidNode>(dist(rng), dist(rng), dist(rng), 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.f, 5.f, 10.f, 3.14f, true);
-        boids_.push_back(temp_predator.get());
-        AddChild(std::move(temp_predator));
+    // 4000 boids and 5 predators with default parameters and time step size 0.1, normally distributed around (0,0) 
+    sim_.set_time_step_size(0.1f);
+    sim_.warn_slow_steps_ = true;
+    sim_.set_thread_count(std::max(std::thread::hardware_concurrency(), 1u));
+    sim_.spawn(4000, 5);
+    prey_batch_ = add_batch_node(false);
+    predator_batch_ = add_batch_node(true);
+    for (size_t i = 0; i < sim_.size(); ++i) {
+        add_boid_node(i);
     }
+    mark_controlled_predator();
+    set_instanced_rendering(instanced_rendering_);
+    sim_.on_step_ = [this](const FlockSimulation&) {
+        on_step();
+    };
 }
 
-std::vector<BoidNode*> FlockNode::get_close_boids(const BoidNode& boid) {
-    std::vector<BoidNode*> close_boids;
-    if (boid.is_predator()) {
-        return close_boids;
+void FlockNode::mark_controlled_predator() {
+    if (controlled_node_ != nullptr) {
+        controlled_node_->set_mesh_scale(1.0f);
+        controlled_node_ = nullptr;
     }
-
-    auto boid_ptr = &boid;
-    if (quadtree_) {
-        quadtree_->query(boid_ptr, params_[0], 6.28, close_boids);
-        return close_boids;
+    if (sim_.get_controlled_predator() >= 0) {
+        controlled_node_ = boids_[sim_.get_state().id[sim_.get_controlled_predator()]];
+        controlled_node_->set_mesh_scale(3.0f); // make predator larger
     }
+}
 
-    for (const auto& other : boids_) {
-        if (other != &boid) {
-            float distance = glm::length(other->get_position() - boid.get_position());
-            if (distance < params_[0]) {
-                close_boids.push_back(other);
-            }
-        }
+void FlockNode::set_instanced_rendering(bool instanced) {
+    instanced_rendering_ = instanced;
+    prey_batch_->SetActive(instanced);
+    predator_batch_->SetActive(instanced);
+    // Nodes beyond the flock, left over from a larger one, stay hidden.
+    for (size_t id = 0; id < boids_.size(); ++id) {
+        boids_[id]->SetActive(!instanced && id < sim_.size());
     }
-    return close_boids;
 }
 
-std::vector<BoidNode*> FlockNode::get_visible_boids(const BoidNode& boid) {
-    std::vector<BoidNode*> visible_boids;
-    // if (boid.is_predator()) {
-    //     return visible_boids;
-    // }
+SceneNode* FlockNode::add_batch_node(bool predator) {
+    // Each batch gets its own cone rather than the cached one: the instance
+    // attributes are recorded in the VAO, which BoidNodes must not see.
+    std::unique_ptr<SceneNode> batch = make_unique<SceneNode>();
+    batch->CreateComponent<ShadingComponent>(ResourceCache::GetInstance().GetShader<InstancedPhongShader>());
+    batch->CreateComponent<RenderingComponent>(std::shared_ptr<VertexObject>(PrimitiveFactory::CreateCone(0.2f, 0.5f, 25)));
+    batch->CreateComponent<MaterialComponent>(BoidNode::get_shared_material(predator));
+    batch->CreateComponent<InstancingComponent>();
+    SceneNode* batch_ptr = batch.get();
+    AddChild(std::move(batch));
+    return batch_ptr;
+}
 
-    if (quadtree_) {
-        auto boid_ptr = &boid;
-        quadtree_->query(boid_ptr, params_[1], params_[2], visible_boids);
-        return visible_boids;
-    }
+void FlockNode::add_boid(const glm::vec3& position, const glm::vec3& velocity, bool predator) {
+    add_boid_node(sim_.add_boid(position, velocity, predator));
+}
 
-    for (const auto& other : boids_) {
-        if (other != &boid) {
-            float distance = glm::length(other->get_position() - boid.get_position());
-            float angle = glm::acos(glm::dot(glm::normalize(boid.get_velocity()), glm::normalize(other->get_position() - boid.get_position())));
-            if (distance < params_[1] && angle < params_[2] / 2.0f) {
-                visible_boids.push_back(other); 
-            }
-        }
+void FlockNode::add_boid_node(size_t index) {
+    const FlockState& state = sim_.get_state();
+    uint32_t id = state.id[index];
+    if (id < boids_.size()) {
+        // reuse the node a smaller snapshot restore deactivated
+        boids_[id]->set_predator(state.is_predator(index));
+        boids_[id]->SetActive(!instanced_rendering_);
+        headings_[id] = glm::quat(1.f, 0.f, 0.f, 0.f);
+        return;
     }
-    return visible_boids;
+    std::unique_ptr<BoidNode> boid = make_unique<BoidNode>(state.position(index), state.is_predator(index));
+    boid->SetActive(!instanced_rendering_);
+    boids_.push_back(boid.get());
+    headings_.push_back(glm::quat(1.f, 0.f, 0.f, 0.f));
+    AddChild(std::move(boid));
 }
 
-void FlockNode::Update(double delta_time) {
-    // Constants for each behavior strength
+template <typename Frame>
+void FlockNode::update_headings(const Frame& frame, double delta_time) {
+    // Smoothly slerp from current rotation toward target for natural turning.
+    float turn_speed = 5.0f; // units: 1/second, tweakable
+    float alpha = 1.0f - std::exp(-turn_speed * static_cast<float>(delta_time));
+    alpha = glm::clamp(alpha, 0.0f, 1.0f);
 
-    //reconstruct quadtree each frame
+    for (size_t i = 0; i < frame.size(); ++i) {
+        glm::vec3 vel = frame.velocity(i);
+        glm::quat& rotation = headings_[frame.id(i)];
 
-    auto t0 = now();
-    quadtree_ = make_unique<QuadTree>(lower_bounds_, upper_bounds_, 4, boids_);
-    auto t1 = now();
+        if (glm::length(vel) > 0.001f) {
 
-    int totalNeighbors = 0;
-    int maxNeighbors = 0;
+            // Align the model's local +Y axis to the velocity direction.
+            glm::vec3 dir = glm::normalize(vel);
+            const glm::vec3 model_y(0.0f, 1.0f, 0.0f);
+            const float eps = 1e-6f;
 
-    // Per-boid neighbor counting for debugging (counts boids within close range)
-    for (auto& bptr : boids_) {
-        std::vector<BoidNode*> neighbors;
-        if (quadtree_) {
-            // use quadtree query (radius = close range, full circle angle)
-            quadtree_->query(bptr, params_[0], 6.28f, neighbors);
-        } else {
-            // fall back to linear scan
-            for (auto& other : boids_) {
-                if (other == bptr) continue;
-                float distance = glm::length(other->get_position() - bptr->get_position());
-                if (distance < params_[0]) neighbors.push_back(other);
+            glm::quat target_rotation;
+
+            // If dir is (almost) equal to model_y, use identity rotation.
+            if (glm::length2(dir - model_y) < eps) {
+                target_rotation = glm::quat(1.f, 0.f, 0.f, 0.f);
+            } else if (glm::length2(dir + model_y) < eps) {
+                // dir is opposite to model_y: 180 degree rotation around any perpendicular axis
+                glm::vec3 axis = glm::cross(model_y, glm::vec3(1.f, 0.f, 0.f));
+                if (glm::length2(axis) < eps) axis = glm::cross(model_y, glm::vec3(0.f, 0.f, 1.f));
+                axis = glm::normalize(axis);
+                target_rotation = glm::angleAxis(glm::pi<float>(), axis);
+            } else {
+                // General case: rotation that takes +Y to dir
+                target_rotation = glm::rotation(model_y, dir);
             }
+
+            rotation = glm::slerp(rotation, target_rotation, alpha);
         }
-        totalNeighbors += static_cast<int>(neighbors.size());
-        maxNeighbors = std::max(maxNeighbors, static_cast<int>(neighbors.size()));
     }
+}
 
-    double avgNeighbors = boids_.empty() ? 0.0 : static_cast<double>(totalNeighbors) / static_cast<double>(boids_.size());
-    
-
-
-    for (auto& boid_ptr : boids_) {
-        BoidNode& boid = *boid_ptr;
-        std::vector<BoidNode*> visible_boids = get_visible_boids(boid);
-        std::vector<BoidNode*> close_boids = get_close_boids(boid);
-
-        glm::vec3 steer_separation = glm::vec3(0.f);
-        glm::vec3 steer_alignment = glm::vec3(0.f);
-        glm::vec3 steer_cohesion = glm::vec3(0.f);
-
-        glm::vec3 predator_delta = glm::vec3(0.f);
-
-        if (!close_boids.empty()) {
-            for (const BoidNode* other : close_boids) {
-                steer_separation += boid.get_position() - other->get_position();
-                if (other->is_predator()) {
-                    predator_delta = boid.get_position() - other->get_position();
-                    steer_separation += params_[8] * 10 * predator_delta;
-                }
-            }
+template <typename Frame>
+void FlockNode::sync_transforms(const Frame& frame) {
+    for (size_t i = 0; i < frame.size(); ++i) {
+        uint32_t id = frame.id(i);
+        BoidNode& boid = *boids_[id];
+        if (!boid.IsActive()) {
+            continue;
         }
+        boid.set_pose(frame.position(i), headings_[id]);
+    }
+}
 
-        if (!visible_boids.empty()) {
-            for (const BoidNode* other : visible_boids) {
-                steer_alignment += other->get_velocity();
-                steer_cohesion += other->get_position();
-            }
-            steer_alignment /= static_cast<float>(visible_boids.size());
-            steer_cohesion /= static_cast<float>(visible_boids.size());
+template <typename Frame>
+void FlockNode::sync_instances(const Frame& frame) {
+    prey_position_scales_.clear();
+    prey_rotations_.clear();
+    predator_position_scales_.clear();
+    predator_rotations_.clear();
+
+    for (size_t i = 0; i < frame.size(); ++i) {
+        uint32_t id = frame.id(i);
+        // BoidNodes still own the per-boid scale (the controlled predator is larger).
+        glm::vec4 position_scale(frame.position(i), boids_[id]->GetTransform().GetScale().x);
+        const glm::quat& q = headings_[id];
+        glm::vec4 rotation(q.x, q.y, q.z, q.w);
+        if (frame.is_predator(i)) {
+            predator_position_scales_.push_back(position_scale);
+            predator_rotations_.push_back(rotation);
+        } else {
+            prey_position_scales_.push_back(position_scale);
+            prey_rotations_.push_back(rotation);
         }
-        steer_alignment -= boid.get_velocity();
-        steer_cohesion -= boid.get_position();
-
-        // smooth turning at margins
+    }
 
-        float turn_factor = 0.5f;
-        glm::vec3 boundary_turn_acceleration = glm::vec3(0.f);
+    prey_batch_->GetComponentPtr<InstancingComponent>()->UpdateInstances(prey_position_scales_, prey_rotations_);
+    predator_batch_->GetComponentPtr<InstancingComponent>()->UpdateInstances(predator_position_scales_, predator_rotations_);
+}
 
-        if (boid.get_position().x < lower_bounds_.x + margin_) {
-            boundary_turn_acceleration.x += (lower_bounds_.x + margin_ - boid.get_position().x) * turn_factor;
-        } else if (boid.get_position().x > upper_bounds_.x - margin_) {
-            boundary_turn_acceleration.x -= (boid.get_position().x - (upper_bounds_.x - margin_)) * turn_factor;
-        }
+template <typename Frame>
+void FlockNode::sync(const Frame& frame, double delta_time) {
+    PROFILE_SCOPE("transform sync");
+    update_headings(frame, delta_time);
+    if (instanced_rendering_) {
+        sync_instances(frame);
+    } else {
+        sync_transforms(frame);
+    }
+}
 
-        if (boid.get_position().y < lower_bounds_.y + margin_) {
-            boundary_turn_acceleration.y += (lower_bounds_.y + margin_ - boid.get_position().y) * turn_factor;
-        } else if (boid.get_position().y > upper_bounds_.y - margin_) {
-            boundary_turn_acceleration.y -= (boid.get_position().y - (upper_bounds_.y - margin_)) * turn_factor;
-        }
+bool FlockNode::start_recording(const std::string& path) {
+    stop_recording();
+    if (!recorder_.open(path, sim_.size(), sim_.params_.size(), sim_.get_time_step_size())) {
+        recorder_.close();
+        return false;
+    }
+    record_failed_ = false;
+    return true;
+}
 
-        if (boid.get_position().z < lower_bounds_.z + margin_) {
-            boundary_turn_acceleration.z += (lower_bounds_.z + margin_ - boid.get_position().z) * turn_factor;
-        } else if (boid.get_position().z > upper_bounds_.z - margin_) {
-            boundary_turn_acceleration.z -= (boid.get_position().z - (upper_bounds_.z - margin_)) * turn_factor;
-        }
+void FlockNode::stop_recording() {
+    if (recorder_.is_open() && !recorder_.close()) {
+        std::cerr << "Trajectory recording failed" << std::endl;
+    }
+}
 
-        glm::vec3 new_acc = steer_separation * params_[5] + steer_alignment * params_[3] + steer_cohesion * params_[4] + boundary_turn_acceleration;
+bool FlockNode::save_snapshot(const std::string& path) const {
+    FlockSnapshot snapshot;
+    sim_.save(snapshot);
+    return write_snapshot(snapshot, path);
+}
 
-        // if (boid.is_predator()) {
-        //     new_acc = boid.get_acceleration();
-        // }
+bool FlockNode::restore_snapshot(const std::string& path) {
+    FlockSnapshot snapshot;
+    if (!read_snapshot(path, snapshot)) {
+        return false;
+    }
+    if (!sim_.restore(std::move(snapshot))) {
+        std::cerr << "Snapshots only resume bit for bit with the incremental grid or Verlet lists "
+                  << "in deterministic mode" << std::endl;
+        return false;
+    }
 
-        if (glm::length(new_acc) > params_[7]) {
-            new_acc = glm::normalize(new_acc) * params_[7];
-        }
+    // Nodes are named by id, so existing ones carry over; only boids beyond
+    // the current count need new nodes, and nodes beyond the snapshot's
+    // count are deactivated. The snapshot may have been saved after a
+    // reorder, so each new id is looked up in its state slot.
+    const FlockState& state = sim_.get_state();
+    std::vector<uint32_t> slot_of_id(state.size());
+    for (size_t i = 0; i < state.size(); ++i) {
+        slot_of_id[state.id[i]] = static_cast<uint32_t>(i);
+    }
+    while (boids_.size() < state.size()) {
+        add_boid_node(slot_of_id[boids_.size()]);
+    }
+    for (size_t i = 0; i < state.size(); ++i) {
+        boids_[state.id[i]]->set_predator(state.is_predator(i));
+    }
+    set_instanced_rendering(instanced_rendering_);
+    mark_controlled_predator();
+    return true;
+}
 
-        glm::vec3 new_vel = boid.get_velocity() + new_acc * time_step_size_;
+bool FlockNode::start_checkpoints(const std::string& path, int interval, CheckpointMode mode) {
+    stop_checkpoints();
+    checkpoint_interval_ = std::max(interval, 1);
+    return checkpoints_.open(path, mode);
+}
 
-        if (glm::length(new_vel) > params_[6]) {
-            new_vel = glm::normalize(new_vel) * params_[6];
-        }
+void FlockNode::stop_checkpoints() {
+    if (checkpoints_.is_open() && !checkpoints_.close()) {
+        std::cerr << "Writing checkpoints failed" << std::endl;
+    }
+}
 
-        glm::vec3 new_pos = boid.get_position() + new_vel * time_step_size_;
+void FlockNode::on_step() {
+    if (recorder_.is_open() && !record_failed_ &&
+        !recorder_.append(sim_.get_step_count(), sim_.get_state(), sim_.params_)) {
+        record_failed_ = true;
+    }
+    if (checkpoints_.is_open() && sim_.get_step_count() % checkpoint_interval_ == 0) {
+        checkpoints_.submit(sim_.get_step_count(), sim_.get_state(), sim_.params_,
+                            sim_.lower_bounds_, sim_.upper_bounds_);
+    }
+}
 
-        if (glm::length(new_vel) > 0.001f) {
+bool FlockNode::start_replay(const std::string& path) {
+    if (!replay_.open(path) || replay_.get_boid_count() != sim_.size() || replay_.get_frame_count() == 0) {
+        replay_.close();
+        return false;
+    }
+    replay_position_ = 0.0;
+    return true;
+}
 
-            // Align the model's local +Y axis to the velocity direction.
-            glm::vec3 dir = glm::normalize(new_vel);
-            const glm::vec3 model_y(0.0f, 1.0f, 0.0f);
-            const float eps = 1e-6f;
+void FlockNode::stop_replay() {
+    replay_.close();
+}
 
-            glm::quat target_rotation;
+void FlockNode::seek_replay(double frame) {
+    double last = static_cast<double>(replay_.get_frame_count() - 1);
+    replay_position_ = glm::clamp(frame, 0.0, std::max(last, 0.0));
+}
 
-            // If dir is (almost) equal to model_y, use identity rotation.
-            if (glm::length2(dir - model_y) < eps) {
-                target_rotation = glm::quat(1.f, 0.f, 0.f, 0.f);
-            } else if (glm::length2(dir + model_y) < eps) {
-                // dir is opposite to model_y: 180 degree rotation around any perpendicular axis
-                glm::vec3 axis = glm::cross(model_y, glm::vec3(1.f, 0.f, 0.f));
-                if (glm::length2(axis) < eps) axis = glm::cross(model_y, glm::vec3(0.f, 0.f, 1.f));
-                axis = glm::normalize(axis);
-                target_rotation = glm::angleAxis(glm::pi<float>(), axis);
-            } else {
-                // General case: rotation that takes +Y to dir
-                target_rotation = glm::rotation(model_y, dir);
+void FlockNode::Update(double delta_time) {
+    if (is_replaying()) {
+        PROFILE_SCOPE("replay");
+        size_t frame_count = replay_.get_frame_count();
+        if (!replay_paused_) {
+            replay_position_ += delta_time * sim_.steps_per_second_;
+            if (replay_position_ >= static_cast<double>(frame_count - 1)) {
+                replay_position_ = frame_count > 1 ? std::fmod(replay_position_, static_cast<double>(frame_count - 1)) : 0.0;
             }
-
-            // Smoothly slerp from current rotation toward target for natural turning.
-            float turn_speed = 5.0f; // units: 1/second, tweakable
-            float alpha = 1.0f - std::exp(-turn_speed * static_cast<float>(delta_time));
-            glm::quat current = boid.GetTransform().GetRotation();
-            glm::quat new_rotation = glm::slerp(current, target_rotation, glm::clamp(alpha, 0.0f, 1.0f));
-            boid.set_rotation(new_rotation);
-
         }
-
-        boid.set_acceleration(new_acc);
-        boid.set_velocity(new_vel);
-        boid.set_position(new_pos);
+        size_t from = static_cast<size_t>(replay_position_);
+        size_t to = std::min(from + 1, frame_count - 1);
+        ReplayFrame frame{replay_.frame(from), replay_.frame(to), static_cast<float>(replay_position_ - from)};
+        sync(frame, delta_time);
+        return;
     }
 
-    auto t2 = now();
-    double buildMs = ms(t0, t1);
-    double updateMs = ms(t1, t2);
-    if (buildMs + updateMs > 16.67) {
-        std::cout << "Warning: Slow frame! Quadtree build: " << buildMs << " ms, Boid update: " << updateMs << " ms, Total: " << (buildMs + updateMs) << " ms\n";
-        std::cout << "avg neighbors: " << avgNeighbors
-              << ", max neighbors: " << maxNeighbors << "\n";
+    // run however many fixed steps fit into this frame, then draw in between
+    {
+        PROFILE_SCOPE("simulation");
+        sim_.advance(delta_time);
+    }
+    if (record_failed_) {
+        std::cerr << "Trajectory recording stopped: write failed or the boid count changed" << std::endl;
+        stop_recording();
+        record_failed_ = false;
     }
+    sync(LiveFrame{sim_}, delta_time);
 
+    int predator = sim_.get_controlled_predator();
+    if (predator < 0) {
+        return;
+    }
+    FlockState& state = sim_.get_state();
     if (InputManager::GetInstance().IsKeyPressed('W')) {
-        predator_->set_velocity(glm::vec3(0.f, 0.5f, 0.f));
+        state.set_velocity(predator, glm::vec3(0.f, 0.5f, 0.f));
     } else if (InputManager::GetInstance().IsKeyPressed('A')) {
-        predator_->set_velocity(glm::vec3(-0.5f, 0.f, 0.f));
+        state.set_velocity(predator, glm::vec3(-0.5f, 0.f, 0.f));
     } else if (InputManager::GetInstance().IsKeyPressed('S')) {
-        predator_->set_velocity(glm::vec3(0.f, -0.5f, 0.f));
+        state.set_velocity(predator, glm::vec3(0.f, -0.5f, 0.f));
     } else if (InputManager::GetInstance().IsKeyPressed('D')) {
-        predator_->set_velocity(glm::vec3(0.5f, 0.f, 0.f));
+        state.set_velocity(predator, glm::vec3(0.5f, 0.f, 0.f));
     } else if (InputManager::GetInstance().IsKeyPressed(265)) {
-        predator_->set_velocity(glm::vec3(0.f, 0.f, 0.5f));
+        state.set_velocity(predator, glm::vec3(0.f, 0.f, 0.5f));
     } else if (InputManager::GetInstance().IsKeyPressed(264)) {
-        predator_->set_velocity(glm::vec3(0.f, 0.f, -0.5f));
+        state.set_velocity(predator, glm::vec3(0.f, 0.f, -0.5f));
     }
 }
 } // namespace GLOO
\ No newline at end of file
@@ -1,6 +1,8 @@
 // #include <glm/glm.hpp>
 #include "BoidNode.hpp"
-#include "QuadTree.hpp"
+#include "sim/FlockSimulation.hpp"
+#include "sim/Trajectory.hpp"
+#include "sim/Checkpoint.hpp"
 #include <vector>
 #include <memory>
 #include <random>
@@ -12,6 +14,7 @@
 #include "gloo/components/RenderingComponent.hpp"
 #include "gloo/components/ShadingComponent.hpp"
 #include "gloo/components/MaterialComponent.hpp"
+#include "gloo/components/InstancingComponent.hpp"
 
 #include <string>
 #include <vector>
@@ -25,44 +28,135 @@
 
 
 namespace GLOO{
+// Scene node that steps a FlockSimulation and mirrors its state into one
+// BoidNode child per boid. With instanced rendering on (the default) the
+// BoidNodes are left inactive and two batch children draw every prey and
+// every predator with one instanced draw call each.
 class FlockNode : public SceneNode {
     public: 
         FlockNode();
-        FlockNode(std::vector<BoidNode*>&& boids, float time_step_size) : boids_{boids}, time_step_size_{time_step_size} {};
+        // Indexed by FlockState::id; may hold inactive nodes past the
+        // flock's size after restoring a smaller snapshot.
         const std::vector<BoidNode*>& get_boids() const {
             return boids_;
         };
-        void add_boid(std::unique_ptr<BoidNode> boid) {
-            boids_.push_back(boid.get());
-            AddChild(std::move(boid));
+        // Adds a boid to the simulation together with the node that renders it.
+        void add_boid(const glm::vec3& position, const glm::vec3& velocity, bool predator);
+
+        FlockSimulation& get_simulation() {
+            return sim_;
+        };
+        const FlockSimulation& get_simulation() const {
+            return sim_;
         };
 
         void Update(double delta_time) override;
-        glm::vec3 lower_bounds_{-20.f, -20.f, -20.f};
-        glm::vec3 upper_bounds_{20.f, 20.f, 20.f};
-        float margin_ = 1.f;
-
-        std::vector<float> params_ = {
-            1.f, // 0: close range
-            2.0f, // 1: visible range 
-            3.14f, // 2: visible angle
-            1.0f, // 3: alignment strength
-            0.1f, // 4: cohesion strength
-            3.0f, // 5: separation strength
-            8.0f, // 6: max speed
-            0.5f, // 7: max force
-            1.f // 8: predator avoidance
+
+        bool get_instanced_rendering() const {
+            return instanced_rendering_;
+        };
+        // Switches between the per-boid nodes and the two instanced batches.
+        // Per-boid colors from BoidNode::set_color only show when off.
+        void set_instanced_rendering(bool instanced);
+
+        // Appends the state after every simulation step to a trajectory
+        // file until stop_recording(). Recording stops by itself if a write
+        // fails or the boid count changes.
+        bool start_recording(const std::string& path);
+        void stop_recording();
+        bool is_recording() const {
+            return recorder_.is_open();
+        };
+
+        // Writes a compact checkpoint every interval steps until
+        // stop_checkpoints(). Encoding and writing run on a background
+        // thread; a checkpoint due while two are still queued is skipped.
+        bool start_checkpoints(const std::string& path, int interval, CheckpointMode mode);
+        void stop_checkpoints();
+        bool is_checkpointing() const {
+            return checkpoints_.is_open();
+        };
+        const CheckpointWriter& get_checkpoint_writer() const {
+            return checkpoints_;
         };
 
+        // Writes the simulation to a snapshot file, and continues from one
+        // bit for bit. Restoring reuses the existing BoidNodes, adds nodes if
+        // the snapshot holds more boids and deactivates the extra ones if it
+        // holds fewer; add_boid() brings those back. Restoring fails if
+        // the simulation's settings cannot resume exactly (see
+        // FlockSimulation::resumes_exactly()).
+        bool save_snapshot(const std::string& path) const;
+        bool restore_snapshot(const std::string& path);
+
+        // Draws the boids from a recorded trajectory instead of simulating,
+        // at the simulation's steps_per_second_ frames per second, looping
+        // at the end. The file is memory-mapped, so only the frames shown
+        // are read. Fails if it holds a different number of boids.
+        bool start_replay(const std::string& path);
+        void stop_replay();
+        bool is_replaying() const {
+            return replay_.is_open();
+        };
+        size_t get_replay_frame_count() const {
+            return replay_.get_frame_count();
+        };
+        // Fractional frame currently shown.
+        double get_replay_position() const {
+            return replay_position_;
+        };
+        void seek_replay(double frame);
+        bool replay_paused_ = false;
+
     private:
-        std::default_random_engine rng{42};  // fixed seed
+        // Records and checkpoints the step the simulation just took.
+        void on_step();
+        // Adds the node for the boid in state slot index, or reactivates it
+        // if a restore left one for that id. The id must not be past the
+        // next one without a node.
+        void add_boid_node(size_t index);
+        // Points the larger mesh at the controlled predator.
+        void mark_controlled_predator();
+        SceneNode* add_batch_node(bool predator);
+        // The sync functions read boids through a Frame: the live
+        // simulation, or a replayed trajectory (see FlockNode.cpp).
+        // Smooths headings_ toward the current velocities.
+        template <typename Frame>
+        void update_headings(const Frame& frame, double delta_time);
+        // Copies interpolated positions and headings into the active
+        // BoidNodes; inactive (unrendered) nodes are skipped.
+        template <typename Frame>
+        void sync_transforms(const Frame& frame);
+        // Refills the instance buffers of both batch nodes.
+        template <typename Frame>
+        void sync_instances(const Frame& frame);
+        template <typename Frame>
+        void sync(const Frame& frame, double delta_time);
+
+        FlockSimulation sim_;
+        // boids_[id] renders the boid with that FlockState::id, wherever
+        // reordering has moved it in sim_'s state; nodes from sim_.size() on
+        // are inactive leftovers of a larger flock
         std::vector<BoidNode*> boids_;
-        float time_step_size_ = 0.1f;
-        std::vector<BoidNode*> get_visible_boids(const BoidNode& boid);
-        std::vector<BoidNode*> get_close_boids(const BoidNode& boid);
-        BoidNode* predator_;
-        std::normal_distribution<float> dist{0.0f, 10.f};
-        std::unique_ptr<QuadTree> quadtree_ = nullptr;
+        // Smoothed orientation of each boid by id, +Y turned toward its velocity.
+        std::vector<glm::quat> headings_;
+        BoidNode* controlled_node_ = nullptr;
+
+        bool instanced_rendering_ = true;
+        SceneNode* prey_batch_ = nullptr;
+        SceneNode* predator_batch_ = nullptr;
+        // Per-frame instance data, kept to avoid reallocating.
+        std::vector<glm::vec4> prey_position_scales_, prey_rotations_;
+        std::vector<glm::vec4> predator_position_scales_, predator_rotations_;
+
+        TrajectoryWriter recorder_;
+        // Set from the step callback when an append fails; Update() then
+        // stops the recording.
+        bool record_failed_ = false;
+        CheckpointWriter checkpoints_;
+        int checkpoint_interval_ = 1;
+        TrajectoryReader replay_;
+        double replay_position_ = 0.0;
 };
 } // namespace GLOO
 #endif
\ No newline at end of file
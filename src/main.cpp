@@ -1,26 +1,129 @@
 #include <iostream>
 #include <chrono>
+#include <cstring>
+#include <cstdlib>
 
 #include "BoidApp.hpp"
+#include "sim/TraceWriter.hpp"
 
 using namespace GLOO;
 
-int main() {
-  std::unique_ptr<BoidApp> app = make_unique<BoidApp>("boids", glm::ivec2(1440, 900));
+// Flags:
+//   --offscreen       open an invisible window
+//   --frames N        quit after N frames and print the average frame time
+//   --no-instancing   draw one node per boid instead of the instanced batches
+//   --record PATH     record every simulation step to a trajectory file
+//   --checkpoint PATH write a quantized checkpoint every 60 steps
+//   --restore PATH    continue from a snapshot; the snapshot buttons use PATH
+//   --replay PATH     play back a trajectory file instead of simulating
+//   --trace PATH      record a Chrome trace to PATH from the first frame;
+//                     F9 toggles recording (profiler builds only)
+//
+// Frame times without a GPU, using Mesa's software rasterizer:
+//   xvfb-run -a env LIBGL_ALWAYS_SOFTWARE=1 GALLIUM_DRIVER=llvmpipe
+//       ./boids --offscreen --frames 300
+int main(int argc, char** argv) {
+  bool visible = true;
+  bool instanced = true;
+  long max_frames = -1;
+  const char* trace_path = nullptr;
+  const char* record_path = nullptr;
+  const char* replay_path = nullptr;
+  const char* checkpoint_path = nullptr;
+  const char* restore_path = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--offscreen") == 0) {
+      visible = false;
+    } else if (std::strcmp(argv[i], "--no-instancing") == 0) {
+      instanced = false;
+    } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+      max_frames = std::atol(argv[++i]);
+    } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+      record_path = argv[++i];
+    } else if (std::strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+      checkpoint_path = argv[++i];
+    } else if (std::strcmp(argv[i], "--restore") == 0 && i + 1 < argc) {
+      restore_path = argv[++i];
+    } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+      replay_path = argv[++i];
+    } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+      trace_path = argv[++i];
+    } else {
+      std::cerr << "Unknown argument: " << argv[i] << std::endl;
+      return 1;
+    }
+  }
+
+  std::unique_ptr<BoidApp> app = make_unique<BoidApp>("boids", glm::ivec2(1440, 900), visible);
 
   app->SetupScene();
+  app->get_flock()->set_instanced_rendering(instanced);
+  if (restore_path != nullptr) {
+    app->set_snapshot_path(restore_path);
+    if (!app->get_flock()->restore_snapshot(restore_path)) {
+      std::cerr << "Could not restore " << restore_path << std::endl;
+      return 1;
+    }
+  }
+  if (record_path != nullptr) {
+    app->set_trajectory_path(record_path);
+    if (!app->get_flock()->start_recording(record_path)) {
+      std::cerr << "Could not write trajectory to " << record_path << std::endl;
+      return 1;
+    }
+  }
+  if (checkpoint_path != nullptr &&
+      !app->get_flock()->start_checkpoints(checkpoint_path, 60, CheckpointMode::Quantized)) {
+    std::cerr << "Could not write checkpoints to " << checkpoint_path << std::endl;
+    return 1;
+  }
+  if (replay_path != nullptr && !app->get_flock()->start_replay(replay_path)) {
+    std::cerr << "Could not replay " << replay_path
+              << " (missing, not a trajectory, or a different boid count)" << std::endl;
+    return 1;
+  }
+  if (trace_path != nullptr) {
+#ifdef BOIDS_PROFILING
+    app->set_trace_path(trace_path);
+    if (!TraceWriter::instance().start(trace_path)) {
+      std::cerr << "Could not write trace to " << trace_path << std::endl;
+      return 1;
+    }
+#else
+    std::cerr << "--trace needs a build with BOIDS_ENABLE_PROFILER" << std::endl;
+    return 1;
+#endif
+  }
 
   using Clock = std::chrono::high_resolution_clock;
   using TimePoint =
       std::chrono::time_point<Clock, std::chrono::duration<double>>;
   TimePoint last_tick_time = Clock::now();
   TimePoint start_tick_time = last_tick_time;
-  while (!app->IsFinished()) {
+  long frames = 0;
+  while (!app->IsFinished() && (max_frames < 0 || frames < max_frames)) {
     TimePoint current_tick_time = Clock::now();
     double delta_time = (current_tick_time - last_tick_time).count();
     double total_elapsed_time = (current_tick_time - start_tick_time).count();
     app->Tick(delta_time, total_elapsed_time);
     last_tick_time = current_tick_time;
+    frames++;
+  }
+
+  if (max_frames >= 0 && frames > 0) {
+    double total = std::chrono::duration<double>(Clock::now() - start_tick_time).count();
+    std::cout << (instanced ? "instanced" : "per-node") << ": " << frames
+              << " frames, " << 1000.0 * total / frames << " ms/frame"
+              << std::endl;
+  }
+  app->get_flock()->stop_recording();
+  app->get_flock()->stop_checkpoints();
+#ifdef BOIDS_PROFILING
+  if (TraceWriter::instance().is_recording()) {
+    TraceWriter::instance().stop();
+    std::cout << "Trace written (" << TraceWriter::instance().get_dropped()
+              << " events dropped)" << std::endl;
   }
+#endif
   return 0;
 }
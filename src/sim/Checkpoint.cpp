@@ -0,0 +1,491 @@
+#include "Checkpoint.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace GLOO{
+
+namespace {
+const char kMagic[8] = {'B', 'O', 'I', 'D', 'C', 'K', 'P', '\0'};
+const uint32_t kVersion = 1;
+const uint8_t kKeyframe = 0;
+const uint8_t kDeltaFrame = 1;
+const float kQuantizedMax = 65535.f;
+
+template <typename T>
+void put(std::vector<uint8_t>& out, const T& value) {
+    size_t at = out.size();
+    out.resize(at + sizeof(T));
+    std::memcpy(out.data() + at, &value, sizeof(T));
+}
+
+template <typename T>
+bool get(const uint8_t*& p, const uint8_t* end, T& value) {
+    if (static_cast<size_t>(end - p) < sizeof(T)) return false;
+    std::memcpy(&value, p, sizeof(T));
+    p += sizeof(T);
+    return true;
+}
+
+void put_varint(std::vector<uint8_t>& out, uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool get_varint(const uint8_t*& p, const uint8_t* end, uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (p == end) return false;
+        uint8_t byte = *p++;
+        value |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// Maps small differences of either sign to small unsigned values.
+uint32_t zigzag(int32_t value) {
+    return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+}
+
+int32_t unzigzag(uint32_t value) {
+    return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+}
+
+uint32_t quantize(float value, float lower, float upper) {
+    float scale = upper > lower ? kQuantizedMax / (upper - lower) : 0.f;
+    float q = std::floor((value - lower) * scale + 0.5f);
+    // The keyframe box holds every value it is used for; the clamp only
+    // catches rounding at the ends.
+    return static_cast<uint32_t>(std::min(std::max(q, 0.f), kQuantizedMax));
+}
+
+float dequantize(uint32_t q, float lower, float upper) {
+    return lower + static_cast<float>(q) * ((upper - lower) / kQuantizedMax);
+}
+
+uint32_t float_bits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bits_float(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void state_channels(const FlockState& state, const std::vector<float>* channels[6]) {
+    channels[0] = &state.x;
+    channels[1] = &state.y;
+    channels[2] = &state.z;
+    channels[3] = &state.vx;
+    channels[4] = &state.vy;
+    channels[5] = &state.vz;
+}
+
+// Range channel c is quantized over.
+void channel_range(const CheckpointKeyframe& key, int c, float& lower, float& upper) {
+    if (c < 3) {
+        lower = key.box_lower[c];
+        upper = key.box_upper[c];
+    } else {
+        lower = -key.max_speed;
+        upper = key.max_speed;
+    }
+}
+
+uint32_t encode_value(const CheckpointKeyframe& key, int c, float value) {
+    if (key.mode == CheckpointMode::Lossless) {
+        return float_bits(value);
+    }
+    float lower, upper;
+    channel_range(key, c, lower, upper);
+    return quantize(value, lower, upper);
+}
+
+float decode_value(const CheckpointKeyframe& key, int c, uint32_t value) {
+    if (key.mode == CheckpointMode::Lossless) {
+        return bits_float(value);
+    }
+    float lower, upper;
+    channel_range(key, c, lower, upper);
+    return dequantize(value, lower, upper);
+}
+
+// Difference of value from reference, and its inverse.
+uint32_t difference(CheckpointMode mode, uint32_t value, uint32_t reference) {
+    if (mode == CheckpointMode::Lossless) {
+        return value ^ reference;
+    }
+    return zigzag(static_cast<int32_t>(value) - static_cast<int32_t>(reference));
+}
+
+uint32_t undo_difference(CheckpointMode mode, uint32_t diff, uint32_t reference) {
+    if (mode == CheckpointMode::Lossless) {
+        return diff ^ reference;
+    }
+    return static_cast<uint32_t>(static_cast<int32_t>(reference) + unzigzag(diff));
+}
+
+void put_frame_header(std::vector<uint8_t>& out, uint8_t kind, CheckpointMode mode, size_t boid_count,
+                      uint64_t step, const std::vector<float>& params) {
+    put(out, kind);
+    put(out, static_cast<uint8_t>(mode));
+    put(out, static_cast<uint16_t>(0));
+    put(out, static_cast<uint32_t>(boid_count));
+    put(out, step);
+    put(out, static_cast<uint32_t>(params.size()));
+    for (float param : params) {
+        put(out, param);
+    }
+}
+} // namespace
+
+void CheckpointEncoder::encode(uint64_t step, const FlockState& state, const std::vector<float>& params,
+                               const glm::vec3& lower, const glm::vec3& upper, std::vector<uint8_t>& out) {
+    last_was_keyframe_ = !key_.valid || frames_since_key_ >= keyframe_interval_ || !fits_keyframe(state);
+    if (last_was_keyframe_) {
+        put_frame_header(out, kKeyframe, mode_, state.size(), step, params);
+        encode_keyframe(state, params, lower, upper, out);
+        frames_since_key_ = 1;
+    } else {
+        put_frame_header(out, kDeltaFrame, mode_, state.size(), step, params);
+        encode_delta(state, out);
+        ++frames_since_key_;
+    }
+}
+
+bool CheckpointEncoder::fits_keyframe(const FlockState& state) const {
+    if (state.size() != key_.ids.size()) return false;
+    if (mode_ == CheckpointMode::Lossless) return true;
+    for (size_t i = 0; i < state.size(); ++i) {
+        glm::vec3 p = state.position(i);
+        glm::vec3 v = state.velocity(i);
+        // Written as negations so NaN also forces a keyframe.
+        for (int c = 0; c < 3; ++c) {
+            if (!(p[c] >= key_.box_lower[c] && p[c] <= key_.box_upper[c])) return false;
+            if (!(std::fabs(v[c]) <= key_.max_speed)) return false;
+        }
+    }
+    return true;
+}
+
+void CheckpointEncoder::encode_keyframe(const FlockState& state, const std::vector<float>& params,
+                                        const glm::vec3& lower, const glm::vec3& upper, std::vector<uint8_t>& out) {
+    size_t n = state.size();
+    key_.valid = true;
+    key_.mode = mode_;
+    key_.box_lower = lower;
+    key_.box_upper = upper;
+    key_.max_speed = params.size() > 6 ? params[6] : 0.f;
+    for (size_t i = 0; i < n; ++i) {
+        key_.box_lower = glm::min(key_.box_lower, state.position(i));
+        key_.box_upper = glm::max(key_.box_upper, state.position(i));
+        glm::vec3 v = glm::abs(state.velocity(i));
+        key_.max_speed = std::max(key_.max_speed, std::max(v.x, std::max(v.y, v.z)));
+    }
+    if (!(key_.max_speed > 0.f)) key_.max_speed = 1.f;
+
+    const std::vector<uint32_t>& order = morton_.sort(state, key_.box_lower, key_.box_upper);
+    key_.ids.resize(n);
+    for (size_t j = 0; j < n; ++j) {
+        key_.ids[j] = state.id[order[j]];
+    }
+
+    for (int c = 0; c < 3; ++c) {
+        put(out, key_.box_lower[c]);
+    }
+    for (int c = 0; c < 3; ++c) {
+        put(out, key_.box_upper[c]);
+    }
+    put(out, key_.max_speed);
+
+    std::vector<uint64_t> bits((n + 63) / 64, 0);
+    for (size_t j = 0; j < n; ++j) {
+        if (state.is_predator(order[j])) {
+            bits[j >> 6] |= uint64_t(1) << (j & 63);
+        }
+    }
+    for (uint64_t word : bits) {
+        put(out, word);
+    }
+    for (uint32_t id : key_.ids) {
+        put_varint(out, id);
+    }
+
+    const std::vector<float>* channels[6];
+    state_channels(state, channels);
+    for (int c = 0; c < 6; ++c) {
+        std::vector<uint32_t>& values = key_.channels[c];
+        values.resize(n);
+        const std::vector<float>& source = *channels[c];
+        uint32_t previous = 0;
+        for (size_t j = 0; j < n; ++j) {
+            values[j] = encode_value(key_, c, source[order[j]]);
+            put_varint(out, difference(mode_, values[j], previous));
+            previous = values[j];
+        }
+    }
+}
+
+void CheckpointEncoder::encode_delta(const FlockState& state, std::vector<uint8_t>& out) {
+    size_t n = state.size();
+    slot_of_id_.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        slot_of_id_[state.id[i]] = static_cast<uint32_t>(i);
+    }
+
+    const std::vector<float>* channels[6];
+    state_channels(state, channels);
+    for (int c = 0; c < 6; ++c) {
+        const std::vector<float>& source = *channels[c];
+        const std::vector<uint32_t>& reference = key_.channels[c];
+        for (size_t j = 0; j < n; ++j) {
+            uint32_t value = encode_value(key_, c, source[slot_of_id_[key_.ids[j]]]);
+            put_varint(out, difference(mode_, value, reference[j]));
+        }
+    }
+}
+
+bool CheckpointDecoder::decode(const uint8_t* data, size_t size, Checkpoint& out) {
+    const uint8_t* p = data;
+    const uint8_t* end = data + size;
+    uint8_t kind, mode;
+    uint16_t reserved;
+    uint32_t n, param_count;
+    if (!get(p, end, kind) || !get(p, end, mode) || !get(p, end, reserved) || !get(p, end, n) ||
+        !get(p, end, out.step) || !get(p, end, param_count)) {
+        return false;
+    }
+    if (mode > static_cast<uint8_t>(CheckpointMode::Lossless) || param_count > (size - 20) / sizeof(float)) {
+        return false;
+    }
+    out.params.resize(param_count);
+    for (float& param : out.params) {
+        if (!get(p, end, param)) return false;
+    }
+    // Every boid takes at least one byte per channel.
+    if (n > static_cast<size_t>(end - p) / 6) return false;
+
+    if (kind == kKeyframe) {
+        key_.valid = false;
+        key_.mode = static_cast<CheckpointMode>(mode);
+        for (int c = 0; c < 3; ++c) {
+            if (!get(p, end, key_.box_lower[c])) return false;
+        }
+        for (int c = 0; c < 3; ++c) {
+            if (!get(p, end, key_.box_upper[c])) return false;
+        }
+        if (!get(p, end, key_.max_speed)) return false;
+        key_predator_bits_.resize((n + 63) / 64);
+        for (uint64_t& word : key_predator_bits_) {
+            if (!get(p, end, word)) return false;
+        }
+        // Ids must be a permutation of 0..n-1; anything indexing by id
+        // relies on it.
+        key_.ids.resize(n);
+        std::vector<bool> seen(n, false);
+        for (uint32_t& id : key_.ids) {
+            if (!get_varint(p, end, id) || id >= n || seen[id]) return false;
+            seen[id] = true;
+        }
+        for (int c = 0; c < 6; ++c) {
+            std::vector<uint32_t>& values = key_.channels[c];
+            values.resize(n);
+            uint32_t previous = 0;
+            for (uint32_t& value : values) {
+                uint32_t diff;
+                if (!get_varint(p, end, diff)) return false;
+                value = undo_difference(key_.mode, diff, previous);
+                previous = value;
+            }
+        }
+        key_.valid = true;
+    } else if (kind == kDeltaFrame) {
+        if (!key_.valid || static_cast<uint8_t>(key_.mode) != mode || n != key_.ids.size()) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+
+    out.state.resize(n);
+    out.state.predator_bits = key_predator_bits_;
+    std::copy(key_.ids.begin(), key_.ids.end(), out.state.id.begin());
+    std::vector<float>* channels[6] = {
+        &out.state.x, &out.state.y, &out.state.z,
+        &out.state.vx, &out.state.vy, &out.state.vz
+    };
+    for (int c = 0; c < 6; ++c) {
+        std::vector<float>& target = *channels[c];
+        const std::vector<uint32_t>& reference = key_.channels[c];
+        for (size_t j = 0; j < n; ++j) {
+            uint32_t value = reference[j];
+            if (kind == kDeltaFrame) {
+                uint32_t diff;
+                if (!get_varint(p, end, diff)) return false;
+                value = undo_difference(key_.mode, diff, value);
+            }
+            target[j] = decode_value(key_, c, value);
+        }
+    }
+    return p == end;
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    close();
+}
+
+bool CheckpointWriter::open(const std::string& path, CheckpointMode mode, int keyframe_interval) {
+    close();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (file_ == nullptr) return false;
+    uint32_t header[2] = {kVersion, 0};
+    if (std::fwrite(kMagic, sizeof(kMagic), 1, file_) != 1 || std::fwrite(header, sizeof(header), 1, file_) != 1) {
+        std::fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+    encoder_ = CheckpointEncoder(mode, keyframe_interval);
+    stop_ = false;
+    failed_ = false;
+    written_ = 0;
+    dropped_ = 0;
+    bytes_written_ = sizeof(kMagic) + sizeof(header);
+    thread_ = std::thread(&CheckpointWriter::writer_loop, this);
+    return true;
+}
+
+bool CheckpointWriter::submit(uint64_t step, const FlockState& state, const std::vector<float>& params,
+                              const glm::vec3& lower, const glm::vec3& upper) {
+    std::unique_ptr<Job> job;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (file_ == nullptr || failed_) return false;
+        if (pending_.size() >= kMaxPending) {
+            ++dropped_;
+            return false;
+        }
+        if (!free_.empty()) {
+            job = std::move(free_.back());
+            free_.pop_back();
+        }
+    }
+    if (job == nullptr) {
+        job.reset(new Job());
+    }
+    // Copied outside the lock, into storage a previous job already grew.
+    job->step = step;
+    job->state = state;
+    job->params = params;
+    job->lower = lower;
+    job->upper = upper;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back(std::move(job));
+    }
+    cv_.notify_all();
+    return true;
+}
+
+void CheckpointWriter::writer_loop() {
+    for (;;) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+            if (pending_.empty()) return;
+            job = std::move(pending_.front());
+            pending_.pop_front();
+        }
+
+        buffer_.clear();
+        encoder_.encode(job->step, job->state, job->params, job->lower, job->upper, buffer_);
+        uint32_t size = static_cast<uint32_t>(buffer_.size());
+        bool ok = std::fwrite(&size, sizeof(size), 1, file_) == 1 &&
+                  std::fwrite(buffer_.data(), 1, buffer_.size(), file_) == buffer_.size();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ok) {
+            ++written_;
+            bytes_written_ += sizeof(size) + buffer_.size();
+        } else {
+            failed_ = true;
+        }
+        free_.push_back(std::move(job));
+    }
+}
+
+bool CheckpointWriter::close() {
+    if (file_ == nullptr) return false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    thread_.join();
+    bool ok = !failed_;
+    if (std::fclose(file_) != 0) {
+        ok = false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    file_ = nullptr;
+    free_.clear();
+    return ok;
+}
+
+size_t CheckpointWriter::get_written() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return written_;
+}
+
+size_t CheckpointWriter::get_dropped() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+uint64_t CheckpointWriter::get_bytes_written() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_written_;
+}
+
+CheckpointReader::~CheckpointReader() {
+    close();
+}
+
+bool CheckpointReader::open(const std::string& path) {
+    close();
+    file_ = std::fopen(path.c_str(), "rb");
+    if (file_ == nullptr) return false;
+    char magic[8];
+    uint32_t header[2];
+    if (std::fread(magic, sizeof(magic), 1, file_) != 1 || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+        std::fread(header, sizeof(header), 1, file_) != 1 || header[0] != kVersion) {
+        close();
+        return false;
+    }
+    decoder_ = CheckpointDecoder();
+    return true;
+}
+
+void CheckpointReader::close() {
+    if (file_ != nullptr) {
+        std::fclose(file_);
+    }
+    file_ = nullptr;
+}
+
+bool CheckpointReader::next(Checkpoint& out) {
+    if (file_ == nullptr) return false;
+    uint32_t size;
+    if (std::fread(&size, sizeof(size), 1, file_) != 1) return false;
+    buffer_.resize(size);
+    if (size > 0 && std::fread(buffer_.data(), 1, size, file_) != size) return false;
+    return decoder_.decode(buffer_.data(), buffer_.size(), out);
+}
+} // namespace GLOO
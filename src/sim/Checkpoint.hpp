@@ -0,0 +1,189 @@
+#ifndef CHECKPOINT_HPP_
+#define CHECKPOINT_HPP_
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include "FlockState.hpp"
+#include "MortonOrder.hpp"
+
+namespace GLOO{
+// Compact checkpoints of a flock, for runs too large to store as raw floats.
+//
+// A keyframe sorts the boids along a Z-curve (MortonOrder) and stores their
+// ids in that order, then each of the six position and velocity channels as
+// the difference from the previous boid's value, zigzag varint coded;
+// neighbors on the curve are close in space and usually fly alike, so most
+// differences take one or two bytes. The following keyframe_interval - 1
+// frames keep the keyframe's boid order and store each value as the
+// difference from the same boid in the keyframe.
+//
+// CheckpointMode::Quantized maps positions to 16 bits over the keyframe's
+// box (the simulation bounds, grown to hold every boid) and velocity
+// components to 16 bits over [-v, v], v being the max speed params_[6] or
+// the fastest component if larger. A frame with a boid outside its
+// keyframe's ranges becomes a keyframe, so nothing is ever clamped.
+// CheckpointMode::Lossless stores the float bits and codes differences as
+// XOR. Predator flags are stored with keyframes only, as boids never change
+// side. Multi-byte fields use the host byte order.
+enum class CheckpointMode {
+    Quantized,
+    Lossless
+};
+
+// One decoded checkpoint. Boids come back in the keyframe's Z-curve order
+// with their FlockState::id, which is all that identifies a boid.
+struct Checkpoint {
+    uint64_t step = 0;
+    std::vector<float> params;
+    FlockState state;
+};
+
+// The reference frame deltas are taken against: the keyframe as the decoder
+// will see it, in keyframe order.
+struct CheckpointKeyframe {
+    bool valid = false;
+    CheckpointMode mode = CheckpointMode::Quantized;
+    std::vector<uint32_t> ids;
+    // Quantized values or float bits per channel: x, y, z, vx, vy, vz.
+    std::vector<uint32_t> channels[6];
+    glm::vec3 box_lower{0.f};
+    glm::vec3 box_upper{0.f};
+    float max_speed = 0.f;
+};
+
+class CheckpointEncoder {
+    public:
+        explicit CheckpointEncoder(CheckpointMode mode = CheckpointMode::Quantized, int keyframe_interval = 16)
+            : mode_(mode), keyframe_interval_(keyframe_interval) {}
+
+        // Appends one encoded frame of state to out. lower and upper are the
+        // simulation bounds the position box starts from.
+        void encode(uint64_t step, const FlockState& state, const std::vector<float>& params,
+                    const glm::vec3& lower, const glm::vec3& upper, std::vector<uint8_t>& out);
+        // Makes the next frame a keyframe.
+        void reset() {
+            key_.valid = false;
+        };
+        // Whether the last encode() wrote a keyframe.
+        bool get_last_was_keyframe() const {
+            return last_was_keyframe_;
+        };
+
+    private:
+        bool fits_keyframe(const FlockState& state) const;
+        void encode_keyframe(const FlockState& state, const std::vector<float>& params,
+                             const glm::vec3& lower, const glm::vec3& upper, std::vector<uint8_t>& out);
+        void encode_delta(const FlockState& state, std::vector<uint8_t>& out);
+
+        CheckpointMode mode_;
+        int keyframe_interval_;
+        int frames_since_key_ = 0;
+        bool last_was_keyframe_ = false;
+        CheckpointKeyframe key_;
+        MortonOrder morton_;
+        // slot_of_id_[id] is the boid's index in the state being encoded.
+        std::vector<uint32_t> slot_of_id_;
+};
+
+class CheckpointDecoder {
+    public:
+        // Decodes one frame from encode(). False if the data is malformed or
+        // is a delta frame whose keyframe was not decoded first.
+        bool decode(const uint8_t* data, size_t size, Checkpoint& out);
+
+    private:
+        CheckpointKeyframe key_;
+        std::vector<uint64_t> key_predator_bits_;
+};
+
+// Writes checkpoints to a file from a background thread. submit() only
+// copies the state; encoding and I/O happen on the writer thread, so the
+// simulation does not wait on either. At most kMaxPending copies wait at a
+// time; a submit() beyond that is dropped and counted rather than blocking.
+//
+// File layout: 8-byte magic, uint32 version, uint32 reserved, then one
+// record per checkpoint, a uint32 byte count followed by the encoded frame.
+class CheckpointWriter {
+    public:
+        static const size_t kMaxPending = 2;
+
+        CheckpointWriter() {}
+        ~CheckpointWriter();
+
+        CheckpointWriter(const CheckpointWriter&) = delete;
+        CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+        bool open(const std::string& path, CheckpointMode mode = CheckpointMode::Quantized, int keyframe_interval = 16);
+        // Queues a copy of state; false if it was dropped or the writer failed.
+        bool submit(uint64_t step, const FlockState& state, const std::vector<float>& params,
+                    const glm::vec3& lower, const glm::vec3& upper);
+        // Writes out everything queued and closes the file. False if any
+        // write failed since open().
+        bool close();
+
+        bool is_open() const {
+            return file_ != nullptr;
+        };
+        size_t get_written() const;
+        size_t get_dropped() const;
+        uint64_t get_bytes_written() const;
+
+    private:
+        struct Job {
+            uint64_t step;
+            FlockState state;
+            std::vector<float> params;
+            glm::vec3 lower, upper;
+        };
+
+        void writer_loop();
+
+        FILE* file_ = nullptr;
+        CheckpointEncoder encoder_;
+        std::vector<uint8_t> buffer_;
+        std::thread thread_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+        std::deque<std::unique_ptr<Job>> pending_;
+        // Jobs handed back by the writer thread, so copies reuse their storage.
+        std::vector<std::unique_ptr<Job>> free_;
+        bool stop_ = false;
+        bool failed_ = false;
+        size_t written_ = 0;
+        size_t dropped_ = 0;
+        uint64_t bytes_written_ = 0;
+};
+
+// Reads a checkpoint file front to back.
+class CheckpointReader {
+    public:
+        CheckpointReader() {}
+        ~CheckpointReader();
+
+        CheckpointReader(const CheckpointReader&) = delete;
+        CheckpointReader& operator=(const CheckpointReader&) = delete;
+
+        bool open(const std::string& path);
+        void close();
+        // Decodes the next checkpoint; false at the end of the file or on
+        // malformed data.
+        bool next(Checkpoint& out);
+
+    private:
+        FILE* file_ = nullptr;
+        CheckpointDecoder decoder_;
+        std::vector<uint8_t> buffer_;
+};
+} // namespace GLOO
+
+#endif // CHECKPOINT_HPP_
@@ -0,0 +1,404 @@
+#include "FlockSimulation.hpp"
+#include "Profiler.hpp"
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+namespace GLOO{
+
+using clock = std::chrono::high_resolution_clock;
+using time_point = std::chrono::time_point<clock>;
+
+inline time_point now() {
+    return clock::now();
+}
+
+inline double ms(time_point t0, time_point t1) {
+    return std::chrono::duration<double, std::milli>(t1 - t0).count();
+}
+
+void FlockSimulation::spawn(int num_boids, int num_predators) {
+    state_.reserve(state_.size() + num_boids + num_predators);
+    for (int i = 0; i < num_boids; ++i) {
+        float x = spawn_positions_();
+        float y = spawn_positions_();
+        float z = spawn_positions_();
+        add_boid(glm::vec3(x, y, z), glm::vec3(0.01f), false);
+    }
+    for (int i = 0; i < num_predators; ++i) {
+        float x = spawn_positions_();
+        float y = spawn_positions_();
+        float z = spawn_positions_();
+        size_t index = add_boid(glm::vec3(x, y, z), glm::vec3(1.0f), true);
+        if (controlled_predator_ < 0) {
+            controlled_predator_ = static_cast<int>(index);
+        }
+    }
+}
+
+void FlockSimulation::save(FlockSnapshot& snapshot) const {
+    snapshot.state = state_;
+    snapshot.params = params_;
+    snapshot.lower_bounds = lower_bounds_;
+    snapshot.upper_bounds = upper_bounds_;
+    snapshot.margin = margin_;
+    snapshot.time_step_size = time_step_size_;
+    snapshot.step_count = step_count_;
+    snapshot.controlled_predator = controlled_predator_;
+    std::ostringstream rng_state;
+    spawn_positions_.write(rng_state);
+    snapshot.rng_state = rng_state.str();
+}
+
+bool FlockSimulation::restore(FlockSnapshot snapshot) {
+    std::istringstream rng_state(snapshot.rng_state);
+    if (!resumes_exactly() || !spawn_positions_.read(rng_state)) {
+        return false;
+    }
+    state_ = std::move(snapshot.state);
+    params_ = std::move(snapshot.params);
+    lower_bounds_ = snapshot.lower_bounds;
+    upper_bounds_ = snapshot.upper_bounds;
+    margin_ = snapshot.margin;
+    time_step_size_ = snapshot.time_step_size;
+    step_count_ = snapshot.step_count;
+    controlled_predator_ = snapshot.controlled_predator;
+
+    // Nothing built from the old state may survive: the previous positions
+    // for interpolation, the index and the neighbor lists.
+    next_state_.clear();
+    accumulator_ = 0.0;
+    interpolation_alpha_ = 1.f;
+    index_ = nullptr;
+    incremental_grid_.invalidate();
+    verlet_.invalidate();
+    return true;
+}
+
+size_t FlockSimulation::add_boid(const glm::vec3& position, const glm::vec3& velocity, bool predator) {
+    return state_.push_back(position, velocity, predator);
+}
+
+void FlockSimulation::build_index() {
+    built_index_type_ = index_type_;
+    if (index_type_ != SpatialIndexType::IncrementalGrid) {
+        // it will have missed this step's moves by the time it is used again
+        incremental_grid_.invalidate();
+    }
+    if (index_type_ == SpatialIndexType::QuadTree) {
+        quadtree_ = std::unique_ptr<QuadTree>(new QuadTree(lower_bounds_, upper_bounds_, 4, state_));
+        index_ = quadtree_.get();
+    } else if (index_type_ == SpatialIndexType::LinearOctree) {
+        quadtree_ = nullptr;
+        octree_.build(lower_bounds_, upper_bounds_, kOctreeLeafCapacity, state_);
+        index_ = &octree_;
+    } else if (index_type_ == SpatialIndexType::IncrementalGrid) {
+        quadtree_ = nullptr;
+        incremental_grid_.update(lower_bounds_, upper_bounds_, params_[1], state_, rebuild_fraction_);
+        index_ = &incremental_grid_;
+    } else {
+        // cells sized to the visible range so a query touches at most 3x3x3 cells
+        quadtree_ = nullptr;
+        grid_.build(lower_bounds_, upper_bounds_, params_[1], state_);
+        index_ = &grid_;
+    }
+}
+
+void FlockSimulation::reorder() {
+    morton_.sort(state_, lower_bounds_, upper_bounds_);
+    morton_.apply(state_, reorder_scratch_);
+    // boid indices changed under the cells' and boids' lists
+    incremental_grid_.invalidate();
+    verlet_.invalidate();
+    if (controlled_predator_ >= 0) {
+        controlled_predator_ = static_cast<int>(morton_.inverse()[controlled_predator_]);
+    }
+}
+
+void FlockSimulation::sort_by_id(std::vector<uint32_t>& boids) const {
+    const std::vector<uint32_t>& id = state_.id;
+    std::sort(boids.begin(), boids.end(), [&id](uint32_t a, uint32_t b) {
+        return id[a] < id[b];
+    });
+}
+
+void FlockSimulation::steer_range(size_t begin, size_t end) {
+    std::vector<uint32_t> visible_boids;
+    std::vector<uint32_t> close_boids;
+    std::vector<uint32_t> candidates;
+    NeighborBlock block;
+    NearestNeighbors nearest;
+    long close_count = 0;
+    long visible_count = 0;
+    int max_close = 0;
+    int max_visible = 0;
+    float search_radius = std::max(params_[0], params_[1]);
+
+    for (size_t i = begin; i < end; ++i) {
+        glm::vec3 position = state_.position(i);
+        glm::vec3 velocity = state_.velocity(i);
+
+        glm::vec3 steer_separation = glm::vec3(0.f);
+        glm::vec3 steer_alignment = glm::vec3(0.f);
+        glm::vec3 steer_cohesion = glm::vec3(0.f);
+        int num_close = 0;
+        int num_visible = 0;
+
+        if (steering_kernel_ == SteeringKernel::NeighborLists || topological_neighbors_ > 0 || deterministic_) {
+            if (topological_neighbors_ > 0) {
+                // the k nearest in each range instead of all of them
+                size_t k = static_cast<size_t>(topological_neighbors_);
+                index_->nearest(static_cast<uint32_t>(i), k, params_[1], params_[2], nearest);
+                visible_boids.clear();
+                for (const NearestNeighbors::Entry& entry : nearest.entries()) {
+                    visible_boids.push_back(entry.boid);
+                }
+                index_->nearest(static_cast<uint32_t>(i), k, params_[0], kFullCircle, nearest);
+                close_boids.clear();
+                for (const NearestNeighbors::Entry& entry : nearest.entries()) {
+                    close_boids.push_back(entry.boid);
+                }
+            } else if (use_verlet_lists()) {
+                // exact ranges and view cone against the cached candidates
+                NeighborGather gather(position, velocity, params_[0], params_[1], params_[2]);
+                close_boids.clear();
+                visible_boids.clear();
+                const uint32_t* neighbors = verlet_.neighbors(i);
+                for (size_t k = 0, count = verlet_.neighbor_count(i); k < count; ++k) {
+                    gather.classify(neighbors[k], state_.position(neighbors[k]), close_boids, visible_boids);
+                }
+            } else {
+                // one traversal fills both lists; close range is full circle
+                index_->gather(static_cast<uint32_t>(i), params_[0], params_[1], params_[2], close_boids, visible_boids);
+            }
+            if (state_.is_predator(i)) {
+                // predators are not pushed apart by their neighbors
+                close_boids.clear();
+            }
+            if (deterministic_) {
+                // float sums depend on order; ids do not change with index or reordering
+                sort_by_id(close_boids);
+                sort_by_id(visible_boids);
+            }
+
+            glm::vec3 predator_delta = glm::vec3(0.f);
+
+            for (uint32_t other : close_boids) {
+                steer_separation += position - state_.position(other);
+                if (state_.is_predator(other)) {
+                    predator_delta = position - state_.position(other);
+                    steer_separation += params_[8] * 10 * predator_delta;
+                }
+            }
+
+            for (uint32_t other : visible_boids) {
+                steer_alignment += state_.velocity(other);
+                steer_cohesion += state_.position(other);
+            }
+            num_close = static_cast<int>(close_boids.size());
+            num_visible = static_cast<int>(visible_boids.size());
+        } else {
+            // masked accumulation over every candidate near the boid
+            if (use_verlet_lists()) {
+                block.load(state_, verlet_.neighbors(i), verlet_.neighbor_count(i));
+            } else {
+                index_->candidates(static_cast<uint32_t>(i), search_radius, candidates);
+                block.load(state_, candidates);
+            }
+            SteeringQuery query(position, velocity, params_[0], params_[1], params_[2],
+                                params_[8] * 10, !state_.is_predator(i));
+            SteeringSums sums = accumulate_steering(query, block, steering_kernel_);
+            steer_separation = sums.separation;
+            steer_alignment = sums.alignment;
+            steer_cohesion = sums.cohesion;
+            num_close = sums.close_count;
+            num_visible = sums.visible_count;
+        }
+
+        if (collect_stats_) {
+            close_count += num_close;
+            visible_count += num_visible;
+            max_close = std::max(max_close, num_close);
+            max_visible = std::max(max_visible, num_visible);
+        }
+
+        if (num_visible > 0) {
+            steer_alignment /= static_cast<float>(num_visible);
+            steer_cohesion /= static_cast<float>(num_visible);
+        }
+        steer_alignment -= velocity;
+        steer_cohesion -= position;
+
+        // smooth turning at margins
+
+        float turn_factor = 0.5f;
+        glm::vec3 boundary_turn_acceleration = glm::vec3(0.f);
+
+        if (position.x < lower_bounds_.x + margin_) {
+            boundary_turn_acceleration.x += (lower_bounds_.x + margin_ - position.x) * turn_factor;
+        } else if (position.x > upper_bounds_.x - margin_) {
+            boundary_turn_acceleration.x -= (position.x - (upper_bounds_.x - margin_)) * turn_factor;
+        }
+
+        if (position.y < lower_bounds_.y + margin_) {
+            boundary_turn_acceleration.y += (lower_bounds_.y + margin_ - position.y) * turn_factor;
+        } else if (position.y > upper_bounds_.y - margin_) {
+            boundary_turn_acceleration.y -= (position.y - (upper_bounds_.y - margin_)) * turn_factor;
+        }
+
+        if (position.z < lower_bounds_.z + margin_) {
+            boundary_turn_acceleration.z += (lower_bounds_.z + margin_ - position.z) * turn_factor;
+        } else if (position.z > upper_bounds_.z - margin_) {
+            boundary_turn_acceleration.z -= (position.z - (upper_bounds_.z - margin_)) * turn_factor;
+        }
+
+        glm::vec3 new_acc = steer_separation * params_[5] + steer_alignment * params_[3] + steer_cohesion * params_[4] + boundary_turn_acceleration;
+
+        if (glm::length(new_acc) > params_[7]) {
+            new_acc = glm::normalize(new_acc) * params_[7];
+        }
+
+        glm::vec3 new_vel = velocity + new_acc * time_step_size_;
+
+        if (glm::length(new_vel) > params_[6]) {
+            new_vel = glm::normalize(new_vel) * params_[6];
+        }
+
+        glm::vec3 new_pos = position + new_vel * time_step_size_;
+
+        next_state_.set_velocity(i, new_vel);
+        next_state_.set_position(i, new_pos);
+    }
+
+    if (collect_stats_) {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        total_close_neighbors_ += close_count;
+        total_visible_neighbors_ += visible_count;
+        last_stats_.max_close_neighbors = std::max(last_stats_.max_close_neighbors, max_close);
+        last_stats_.max_visible_neighbors = std::max(last_stats_.max_visible_neighbors, max_visible);
+    }
+}
+
+void FlockSimulation::step() {
+    PROFILE_SCOPE("step");
+    //reconstruct neighbor index each step
+
+    // Reordering before the step keeps next_state_ in the same order once
+    // the buffers swap, so interpolation still pairs up the right boids.
+    double reorder_ms = 0.0;
+    if (reorder_interval_ > 0 && step_count_ % reorder_interval_ == 0) {
+        PROFILE_SCOPE("reorder");
+        auto r0 = now();
+        reorder();
+        reorder_ms = ms(r0, now());
+    }
+
+    auto t0 = now();
+    bool rebuilt_lists = false;
+    if (!use_verlet_lists()) {
+        PROFILE_SCOPE("index build");
+        build_index();
+    } else {
+        float radius = std::max(params_[0], params_[1]);
+        if (index_ == nullptr || built_index_type_ != index_type_ ||
+            verlet_.needs_rebuild(state_, radius, verlet_skin_)) {
+            {
+                PROFILE_SCOPE("index build");
+                build_index();
+            }
+            PROFILE_SCOPE("neighbor lists");
+            verlet_.build(*index_, state_, radius, verlet_skin_, pool_);
+            rebuilt_lists = true;
+        }
+    }
+    auto t1 = now();
+
+    last_stats_ = StepStats();
+    last_stats_.reorder_ms = reorder_ms;
+    if (use_verlet_lists()) {
+        last_stats_.neighbor_lists_rebuilt = rebuilt_lists;
+        last_stats_.neighbor_list_entries = verlet_.size();
+    }
+    total_close_neighbors_ = 0;
+    total_visible_neighbors_ = 0;
+
+    next_state_.resize(state_.size());
+    next_state_.predator_bits = state_.predator_bits;
+    next_state_.id = state_.id;
+    {
+        // neighbor gathers are interleaved with steering per boid, so they
+        // are timed as part of this zone
+        PROFILE_SCOPE("steering");
+        pool_.parallel_for(state_.size(), kStepChunkSize, [this](size_t begin, size_t end) {
+            PROFILE_SCOPE("steer chunk");
+            steer_range(begin, end);
+        });
+    }
+    std::swap(state_, next_state_);
+    ++step_count_;
+
+    auto t2 = now();
+    last_stats_.index_build_ms = ms(t0, t1);
+    last_stats_.steer_ms = ms(t1, t2);
+    if (index_type_ == SpatialIndexType::QuadTree) {
+        last_stats_.index_node_count = quadtree_->node_count();
+    } else if (index_type_ == SpatialIndexType::LinearOctree) {
+        last_stats_.index_node_count = octree_.get_node_count();
+    } else if (index_type_ == SpatialIndexType::IncrementalGrid) {
+        last_stats_.index_relocations = incremental_grid_.get_relocations();
+        last_stats_.index_rebuilt = incremental_grid_.get_rebuilt();
+    }
+    if (collect_stats_ && state_.size() > 0) {
+        last_stats_.avg_close_neighbors = static_cast<double>(total_close_neighbors_) / state_.size();
+        last_stats_.avg_visible_neighbors = static_cast<double>(total_visible_neighbors_) / state_.size();
+    }
+
+    double buildMs = last_stats_.index_build_ms;
+    double updateMs = last_stats_.steer_ms;
+    bool slow = buildMs + updateMs > 16.67;
+#ifdef BOIDS_PROFILING
+    if (slow && TraceWriter::instance().is_recording()) {
+        TraceWriter::instance().instant("slow step");
+    }
+#endif
+    if (warn_slow_steps_ && slow) {
+        std::cout << "Warning: Slow frame! Index build: " << buildMs << " ms, Boid update: " << updateMs << " ms, Total: " << (buildMs + updateMs) << " ms\n";
+        if (collect_stats_) {
+            std::cout << "avg neighbors: " << last_stats_.avg_close_neighbors
+                  << ", max neighbors: " << last_stats_.max_close_neighbors << "\n";
+        }
+    }
+
+    if (on_step_) {
+        on_step_(*this);
+    }
+}
+
+int FlockSimulation::advance(double real_seconds) {
+    double interval = 1.0 / std::max(steps_per_second_, 1e-3f);
+    accumulator_ += real_seconds;
+
+    int steps = 0;
+    while (accumulator_ >= interval && steps < max_substeps_) {
+        step();
+        accumulator_ -= interval;
+        ++steps;
+    }
+    if (accumulator_ >= interval) {
+        // fell behind: drop the backlog instead of catching up next frame
+        accumulator_ = std::fmod(accumulator_, interval);
+    }
+    interpolation_alpha_ = static_cast<float>(accumulator_ / interval);
+    return steps;
+}
+
+glm::vec3 FlockSimulation::get_interpolated_position(size_t i) const {
+    // boids added since the last step have no previous position
+    if (i >= next_state_.size()) {
+        return state_.position(i);
+    }
+    return glm::mix(next_state_.position(i), state_.position(i), interpolation_alpha_);
+}
+} // namespace GLOO
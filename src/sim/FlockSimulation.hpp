@@ -0,0 +1,269 @@
+#ifndef FLOCK_SIMULATION_HPP_
+#define FLOCK_SIMULATION_HPP_
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <mutex>
+#include <functional>
+#include <glm/glm.hpp>
+#include "FlockState.hpp"
+#include "SpatialIndex.hpp"
+#include "QuadTree.hpp"
+#include "UniformGrid.hpp"
+#include "LinearOctree.hpp"
+#include "IncrementalGrid.hpp"
+#include "VerletList.hpp"
+#include "MortonOrder.hpp"
+#include "SteeringKernel.hpp"
+#include "ThreadPool.hpp"
+#include "Snapshot.hpp"
+#include "NormalSampler.hpp"
+
+namespace GLOO{
+// Timings and neighbor counts for the most recent step. Neighbor counts are
+// only filled in when FlockSimulation::collect_stats_ is set.
+struct StepStats {
+    double index_build_ms = 0.0;
+    double steer_ms = 0.0;
+    // Time spent Morton-sorting the state; 0 on steps that did not reorder.
+    double reorder_ms = 0.0;
+    // Nodes in the tree built this step; 0 for the uniform grid.
+    size_t index_node_count = 0;
+    // Boids the incremental grid moved to another cell this step, and
+    // whether it fell back to a full rebuild instead.
+    size_t index_relocations = 0;
+    bool index_rebuilt = false;
+    // With verlet_lists_: whether this step rebuilt the index and the lists,
+    // and the number of cached candidates.
+    bool neighbor_lists_rebuilt = false;
+    size_t neighbor_list_entries = 0;
+    double avg_close_neighbors = 0.0;
+    double avg_visible_neighbors = 0.0;
+    int max_close_neighbors = 0;
+    int max_visible_neighbors = 0;
+};
+
+// The boids simulation proper: owns the SoA state, the parameters and the
+// neighbor index, and has no dependency on the scene graph or OpenGL.
+// FlockNode drives it once per frame and copies the result into BoidNodes.
+class FlockSimulation {
+    public:
+        FlockSimulation() {};
+
+        // Adds num_boids prey and num_predators predators, normally
+        // distributed around the origin. The first predator added becomes the
+        // controlled predator.
+        void spawn(int num_boids, int num_predators);
+        size_t add_boid(const glm::vec3& position, const glm::vec3& velocity, bool predator);
+        // Reseeds the generator spawn() draws positions from.
+        void seed(unsigned value) {
+            spawn_positions_.seed(value);
+        };
+
+        // Copies out everything later steps depend on apart from the run
+        // settings; see FlockSnapshot.
+        void save(FlockSnapshot& snapshot) const;
+        // Takes over snapshot's arrays without copying them (pass a copy to
+        // fork several runs from one snapshot). The neighbor index and any
+        // cached lists are rebuilt on the next step and the real-time
+        // accumulator starts empty. Refuses, leaving the simulation as it
+        // was, when resumes_exactly() is false (see FlockSnapshot) or the
+        // snapshot's generator state does not parse.
+        bool restore(FlockSnapshot snapshot);
+        // Whether a restore with the current settings continues bit for bit:
+        // the incremental grid and Verlet lists only do in deterministic_
+        // mode.
+        bool resumes_exactly() const {
+            return deterministic_ || (index_type_ != SpatialIndexType::IncrementalGrid && !use_verlet_lists());
+        };
+
+        // Advances every boid by time_step_size_. Steering reads the current
+        // state and writes a second buffer that is swapped in afterwards, so
+        // the result does not depend on boid order or thread count.
+        void step();
+
+        // Fixed-timestep scheduler for real-time callers. Adds real_seconds to
+        // an accumulator and runs one step() per 1 / steps_per_second_ of it,
+        // at most max_substeps_ per call; time beyond that is dropped so a
+        // slow frame cannot snowball. Returns the number of steps taken.
+        // Headless runs skip this and call step() back to back.
+        int advance(double real_seconds);
+
+        // Fraction of a step left in the accumulator after the last advance(),
+        // in [0, 1).
+        float get_interpolation_alpha() const {
+            return interpolation_alpha_;
+        };
+        // Position of boid i between the previous and the current step,
+        // blended by get_interpolation_alpha(), for rendering between steps.
+        glm::vec3 get_interpolated_position(size_t i) const;
+
+        const FlockState& get_state() const {
+            return state_;
+        };
+        FlockState& get_state() {
+            return state_;
+        };
+        size_t size() const {
+            return state_.size();
+        };
+
+        // Steps taken since construction.
+        uint64_t get_step_count() const {
+            return step_count_;
+        };
+
+        // Index of the predator steered from the keyboard, or -1 if none.
+        int get_controlled_predator() const {
+            return controlled_predator_;
+        };
+        float get_time_step_size() const {
+            return time_step_size_;
+        };
+        void set_time_step_size(float time_step_size) {
+            time_step_size_ = time_step_size;
+        };
+
+        const StepStats& get_last_stats() const {
+            return last_stats_;
+        };
+
+        unsigned get_thread_count() const {
+            return pool_.get_thread_count();
+        };
+        void set_thread_count(unsigned num_threads) {
+            pool_.set_thread_count(num_threads);
+        };
+
+        glm::vec3 lower_bounds_{-20.f, -20.f, -20.f};
+        glm::vec3 upper_bounds_{20.f, 20.f, 20.f};
+        float margin_ = 1.f;
+
+        std::vector<float> params_ = {
+            1.f, // 0: close range
+            2.0f, // 1: visible range
+            3.14f, // 2: visible angle
+            1.0f, // 3: alignment strength
+            0.1f, // 4: cohesion strength
+            3.0f, // 5: separation strength
+            8.0f, // 6: max speed
+            0.5f, // 7: max force
+            1.f // 8: predator avoidance
+        };
+
+        // Simulation steps per second of real time when driven by advance().
+        float steps_per_second_ = 60.f;
+        // Catch-up cap for advance().
+        int max_substeps_ = 4;
+
+        // Sort the state along a Z-curve at the start of every
+        // reorder_interval_-th step so neighbors sit close in memory; 0 turns
+        // it off. Boids change index when this happens: FlockState::id
+        // follows each boid, and get_controlled_predator() is remapped.
+        int reorder_interval_ = 0;
+
+        // How neighbor contributions are summed. The vector kernels mask
+        // every candidate in the 27 cells around a boid, several times the
+        // visible sphere, so at the default 4k-boid flock the list path is
+        // faster (about 2.8 ms against 4.0 ms per step with AVX2). Try
+        // best_steering_kernel() from about 20k boids on, or with Verlet
+        // lists, whose candidates are tighter; bench_steering_kernel
+        // compares them on the machine at hand.
+        SteeringKernel steering_kernel_ = SteeringKernel::NeighborLists;
+
+        // Neighbor index rebuilt (or, for the incremental grid, updated) at
+        // the start of every step.
+        SpatialIndexType index_type_ = SpatialIndexType::UniformGrid;
+        // The incremental grid rebuilds from scratch when more than this
+        // fraction of the boids changed cell in one step.
+        float rebuild_fraction_ = 0.25f;
+
+        // Cache each boid's candidates within the larger of the close and
+        // visible ranges plus verlet_skin_ and reuse them across steps; the
+        // index and the lists are rebuilt only once some boid has moved more
+        // than verlet_skin_ / 2. Steering still applies the exact ranges and
+        // the view cone every step.
+        bool verlet_lists_ = false;
+        float verlet_skin_ = 0.5f;
+
+        // Topological flocking: when positive, each boid steers by only its
+        // topological_neighbors_ nearest boids within each range (the boid
+        // itself included) instead of every boid in range, which bounds the
+        // per-boid cost in dense clusters. Uses the neighbor-list path
+        // whatever steering_kernel_ is, and rebuilds the index every step
+        // even with verlet_lists_ set.
+        int topological_neighbors_ = 0;
+
+        // Deterministic mode: each boid sums its neighbors sorted by
+        // FlockState::id, on the neighbor-list path whatever
+        // steering_kernel_ is. Every boid is steered by one thread into its
+        // own slot and nothing is reduced across threads, so the result is
+        // then the same bit for bit across thread counts, index types,
+        // Verlet lists and reordering. Costs a sort of each neighbor list.
+        bool deterministic_ = false;
+
+        // Count neighbors per boid into get_last_stats() while steering.
+        bool collect_stats_ = false;
+        // Print a warning for steps slower than a 60 Hz frame. Off by
+        // default so tools and benchmarks keep stdout to themselves; the
+        // viewer's FlockNode turns it on.
+        bool warn_slow_steps_ = false;
+
+        // Called at the end of every step(), after the new state is in
+        // place, e.g. to record it.
+        std::function<void(const FlockSimulation&)> on_step_;
+
+    private:
+        void build_index();
+        void reorder();
+        // Steers boids [begin, end) from state_ into next_state_.
+        void steer_range(size_t begin, size_t end);
+        bool use_verlet_lists() const {
+            return verlet_lists_ && topological_neighbors_ == 0;
+        };
+        // Sorts boid indices by id, for deterministic_.
+        void sort_by_id(std::vector<uint32_t>& boids) const;
+
+        // Boids per parallel_for chunk in the steering pass.
+        static const size_t kStepChunkSize = 256;
+        // View angle that disables the cone test.
+        static constexpr float kFullCircle = 6.28f;
+        // Boids per LinearOctree leaf before it splits.
+        static const int kOctreeLeafCapacity = 8;
+
+        FlockState state_;
+        // Scratch for step(); between steps it holds the state before the
+        // last step, which get_interpolated_position() blends from.
+        FlockState next_state_;
+        float time_step_size_ = 0.1f;
+        uint64_t step_count_ = 0;
+        double accumulator_ = 0.0;
+        float interpolation_alpha_ = 1.f;
+        int controlled_predator_ = -1;
+
+        NormalSampler spawn_positions_{0.0f, 10.f, 42};  // fixed seed
+
+        std::unique_ptr<QuadTree> quadtree_ = nullptr;
+        UniformGrid grid_;
+        LinearOctree octree_;
+        IncrementalGrid incremental_grid_;
+        // Whichever of the indexes above was built this step.
+        const SpatialIndex* index_ = nullptr;
+        SpatialIndexType built_index_type_ = SpatialIndexType::UniformGrid;
+        VerletList verlet_;
+
+        ThreadPool pool_;
+
+        MortonOrder morton_;
+        FlockState reorder_scratch_;
+
+        StepStats last_stats_;
+        // Guards the neighbor counters in last_stats_ while chunks merge.
+        std::mutex stats_mutex_;
+        long total_close_neighbors_ = 0;
+        long total_visible_neighbors_ = 0;
+};
+} // namespace GLOO
+
+#endif // FLOCK_SIMULATION_HPP_
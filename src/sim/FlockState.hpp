@@ -0,0 +1,87 @@
+#ifndef FLOCK_STATE_HPP_
+#define FLOCK_STATE_HPP_
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+
+namespace GLOO{
+// Structure-of-arrays storage for everything the simulation reads and writes
+// per boid. Boid i is the i-th entry of every array; the steering loop
+// streams through these instead of chasing BoidNode pointers.
+struct FlockState {
+    std::vector<float> x, y, z;
+    std::vector<float> vx, vy, vz;
+    // One bit per boid, 64 boids per word.
+    std::vector<uint64_t> predator_bits;
+    // Index each boid was added at. Entries move with their boid when the
+    // state is reordered, so id[i] stays a stable name for whoever sits at i.
+    std::vector<uint32_t> id;
+
+    size_t size() const {
+        return x.size();
+    };
+
+    void reserve(size_t n) {
+        x.reserve(n); y.reserve(n); z.reserve(n);
+        vx.reserve(n); vy.reserve(n); vz.reserve(n);
+        predator_bits.reserve((n + 63) / 64);
+        id.reserve(n);
+    };
+
+    void resize(size_t n) {
+        x.resize(n); y.resize(n); z.resize(n);
+        vx.resize(n); vy.resize(n); vz.resize(n);
+        predator_bits.resize((n + 63) / 64, 0);
+        id.resize(n);
+    };
+
+    void clear() {
+        resize(0);
+    };
+
+    // Appends a boid and returns its index.
+    size_t push_back(const glm::vec3& position, const glm::vec3& velocity, bool predator) {
+        size_t i = size();
+        resize(i + 1);
+        set_position(i, position);
+        set_velocity(i, velocity);
+        set_predator(i, predator);
+        // ids are always a permutation of 0..size-1, so i is unused
+        id[i] = static_cast<uint32_t>(i);
+        return i;
+    };
+
+    glm::vec3 position(size_t i) const {
+        return glm::vec3(x[i], y[i], z[i]);
+    };
+
+    glm::vec3 velocity(size_t i) const {
+        return glm::vec3(vx[i], vy[i], vz[i]);
+    };
+
+    void set_position(size_t i, const glm::vec3& p) {
+        x[i] = p.x; y[i] = p.y; z[i] = p.z;
+    };
+
+    void set_velocity(size_t i, const glm::vec3& v) {
+        vx[i] = v.x; vy[i] = v.y; vz[i] = v.z;
+    };
+
+    bool is_predator(size_t i) const {
+        return (predator_bits[i >> 6] >> (i & 63)) & 1u;
+    };
+
+    void set_predator(size_t i, bool predator) {
+        uint64_t mask = uint64_t(1) << (i & 63);
+        if (predator) {
+            predator_bits[i >> 6] |= mask;
+        } else {
+            predator_bits[i >> 6] &= ~mask;
+        }
+    };
+};
+} // namespace GLOO
+
+#endif // FLOCK_STATE_HPP_
@@ -0,0 +1,69 @@
+#ifndef FRAME_ARENA_HPP_
+#define FRAME_ARENA_HPP_
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <type_traits>
+
+namespace GLOO{
+// Bump allocator for data that lives for one frame. allocate() hands out
+// slices of one large block; reset() makes the whole block available again
+// without freeing it. When a frame needs more than the block holds, the
+// excess comes from overflow blocks, and the next reset() grows the main
+// block to the frame's total so later frames fit in one allocation.
+// Only for trivially destructible types: nothing is ever destroyed.
+class FrameArena {
+    public:
+        FrameArena() {};
+
+        FrameArena(const FrameArena&) = delete;
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        template <typename T>
+        T* allocate(size_t count) {
+            static_assert(std::is_trivially_destructible<T>::value,
+                          "FrameArena never runs destructors");
+            return static_cast<T*>(allocate_bytes(count * sizeof(T), alignof(T)));
+        };
+
+        void reset() {
+            if (!overflow_.empty()) {
+                capacity_ += overflow_bytes_;
+                block_.reset(new char[capacity_]);
+                overflow_.clear();
+                overflow_bytes_ = 0;
+            }
+            offset_ = 0;
+        };
+
+        // Bytes handed out since the last reset().
+        size_t used() const {
+            return offset_ + overflow_bytes_;
+        };
+        size_t capacity() const {
+            return capacity_;
+        };
+
+    private:
+        void* allocate_bytes(size_t bytes, size_t alignment) {
+            size_t start = (offset_ + alignment - 1) / alignment * alignment;
+            if (start + bytes <= capacity_) {
+                offset_ = start + bytes;
+                return block_.get() + start;
+            }
+            // new[] memory is aligned for any fundamental type
+            overflow_.push_back(std::unique_ptr<char[]>(new char[bytes]));
+            overflow_bytes_ += bytes;
+            return overflow_.back().get();
+        };
+
+        std::unique_ptr<char[]> block_;
+        size_t capacity_ = 0;
+        size_t offset_ = 0;
+        std::vector<std::unique_ptr<char[]>> overflow_;
+        size_t overflow_bytes_ = 0;
+};
+} // namespace GLOO
+
+#endif // FRAME_ARENA_HPP_
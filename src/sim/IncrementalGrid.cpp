@@ -0,0 +1,217 @@
+#include "IncrementalGrid.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+namespace GLOO{
+
+namespace {
+// Fill spare slots. Squared distances from kEmptyPosition overflow to
+// infinity, so distance tests drop it without a separate check.
+const uint32_t kEmpty = UINT32_MAX;
+const glm::vec3 kEmptyPosition(FLT_MAX);
+}
+
+void IncrementalGrid::update(glm::vec3 lower_bound, glm::vec3 upper_bound, float cell_size,
+                             const FlockState& state, float max_moved_fraction) {
+    size_t n = state.size();
+    if (&state != state_ || n != cell_of_.size() || lower_bound != lower_bound_ ||
+        upper_bound != upper_bound_ || cell_size != requested_cell_size_) {
+        valid_ = false;
+    }
+    state_ = &state;
+
+    if (!valid_) {
+        lower_bound_ = lower_bound;
+        upper_bound_ = upper_bound;
+        requested_cell_size_ = cell_size;
+        glm::vec3 extent = upper_bound_ - lower_bound_;
+        float max_extent = std::max(extent.x, std::max(extent.y, extent.z));
+        cell_size_ = std::max(cell_size, max_extent / kMaxCellsPerAxis);
+        dims_ = glm::max(glm::ivec3(glm::ceil(extent / cell_size_)), glm::ivec3(1));
+    }
+
+    // Find every boid's cell first, so a step where too many moved can go
+    // straight to a rebuild instead of relocating them one by one.
+    new_cell_.resize(n);
+    size_t moved = 0;
+    for (size_t i = 0; i < n; ++i) {
+        new_cell_[i] = static_cast<uint32_t>(cell_index(cell_coords(state.position(i))));
+        if (valid_ && new_cell_[i] != cell_of_[i]) {
+            moved++;
+        }
+    }
+
+    if (!valid_ || static_cast<double>(moved) > max_moved_fraction * static_cast<double>(n)) {
+        rebuild();
+        return;
+    }
+
+    rebuilt_ = false;
+    relocations_ = moved;
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t boid = static_cast<uint32_t>(i);
+        if (new_cell_[i] != cell_of_[i] && !relocate(boid, new_cell_[i])) {
+            // new_cell_ is complete, so the rebuild does not care how far
+            // this pass got.
+            rebuild();
+            return;
+        }
+        slot_position_[slot_of_[i]] = state.position(i);
+    }
+}
+
+bool IncrementalGrid::relocate(uint32_t i, uint32_t to) {
+    if (cell_start_[to] + cell_count_[to] == cell_start_[to + 1]) {
+        return false;
+    }
+
+    // Swap-remove from the old cell; its last boid takes this one's slot.
+    uint32_t from = cell_of_[i];
+    uint32_t last = cell_start_[from] + --cell_count_[from];
+    uint32_t hole = slot_of_[i];
+    slot_boid_[hole] = slot_boid_[last];
+    slot_position_[hole] = slot_position_[last];
+    slot_of_[slot_boid_[hole]] = hole;
+    slot_boid_[last] = kEmpty;
+    slot_position_[last] = kEmptyPosition;
+
+    uint32_t slot = cell_start_[to] + cell_count_[to]++;
+    slot_boid_[slot] = i;
+    slot_of_[i] = slot;
+    cell_of_[i] = to;
+    return true;
+}
+
+void IncrementalGrid::rebuild() {
+    size_t n = new_cell_.size();
+    size_t num_cells = static_cast<size_t>(dims_.x) * dims_.y * dims_.z;
+
+    cell_count_.assign(num_cells, 0);
+    for (size_t i = 0; i < n; ++i) {
+        cell_count_[new_cell_[i]]++;
+    }
+    cell_start_.resize(num_cells + 1);
+    cell_start_[0] = 0;
+    for (size_t c = 0; c < num_cells; ++c) {
+        uint32_t capacity = cell_count_[c] + cell_count_[c] / kSpareDivisor + kMinSpare;
+        cell_start_[c + 1] = cell_start_[c] + capacity;
+        cell_count_[c] = 0;
+    }
+
+    slot_boid_.assign(cell_start_[num_cells], kEmpty);
+    slot_position_.assign(cell_start_[num_cells], kEmptyPosition);
+    cell_of_.resize(n);
+    slot_of_.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t cell = new_cell_[i];
+        uint32_t slot = cell_start_[cell] + cell_count_[cell]++;
+        slot_boid_[slot] = static_cast<uint32_t>(i);
+        slot_position_[slot] = state_->position(i);
+        cell_of_[i] = cell;
+        slot_of_[i] = slot;
+    }
+    valid_ = true;
+    rebuilt_ = true;
+    relocations_ = n;
+}
+
+glm::ivec3 IncrementalGrid::cell_coords(const glm::vec3& pos) const {
+    glm::ivec3 coords = glm::ivec3(glm::floor((pos - lower_bound_) / cell_size_));
+    return glm::clamp(coords, glm::ivec3(0), dims_ - 1);
+}
+
+float IncrementalGrid::cell_distance_sq(const glm::ivec3& coords, const glm::vec3& pos) const {
+    glm::vec3 lower = lower_bound_ + glm::vec3(coords) * cell_size_;
+    glm::vec3 upper = lower + cell_size_;
+    // Border cells also hold the boids clamped in from outside the bounds.
+    for (int axis = 0; axis < 3; ++axis) {
+        if (coords[axis] == 0) lower[axis] = -FLT_MAX;
+        if (coords[axis] == dims_[axis] - 1) upper[axis] = FLT_MAX;
+    }
+    glm::vec3 to_cell = glm::clamp(pos, lower, upper) - pos;
+    return glm::dot(to_cell, to_cell);
+}
+
+template <typename Fn>
+void IncrementalGrid::for_each_slot(const glm::vec3& position, float radius, Fn fn) const {
+    if (cell_of_.empty()) return;
+
+    glm::ivec3 lo = cell_coords(position - glm::vec3(radius));
+    glm::ivec3 hi = cell_coords(position + glm::vec3(radius));
+
+    for (int z = lo.z; z <= hi.z; ++z) {
+        for (int y = lo.y; y <= hi.y; ++y) {
+            // Cells along x are adjacent, so scan the whole row, spare
+            // slots included, in one sweep.
+            size_t row_begin = cell_start_[cell_index(glm::ivec3(lo.x, y, z))];
+            size_t row_end = cell_start_[cell_index(glm::ivec3(hi.x, y, z)) + 1];
+            for (size_t slot = row_begin; slot < row_end; ++slot) {
+                fn(slot);
+            }
+        }
+    }
+}
+
+void IncrementalGrid::query(uint32_t boid, float radius, float view_angle, std::vector<uint32_t>& found) const {
+    glm::vec3 pos = state_->position(boid);
+    float radius_sq = radius * radius;
+    ViewCone cone(state_->velocity(boid), view_angle);
+    for_each_slot(pos, radius, [&](size_t slot) {
+        glm::vec3 delta = slot_position_[slot] - pos;
+        if (glm::dot(delta, delta) <= radius_sq && cone.contains(delta)) {
+            found.push_back(slot_boid_[slot]);
+        }
+    });
+}
+
+void IncrementalGrid::gather_impl(const NeighborGather& gather, std::vector<uint32_t>& close, std::vector<uint32_t>& visible) const {
+    for_each_slot(gather.position, gather.radius, [&](size_t slot) {
+        gather.classify(slot_boid_[slot], slot_position_[slot], close, visible);
+    });
+}
+
+void IncrementalGrid::candidates_impl(const glm::vec3& position, float radius, std::vector<uint32_t>& found) const {
+    if (cell_of_.empty()) return;
+
+    glm::ivec3 lo = cell_coords(position - glm::vec3(radius));
+    glm::ivec3 hi = cell_coords(position + glm::vec3(radius));
+
+    // Copy cell by cell to leave out the spare slots.
+    for (int z = lo.z; z <= hi.z; ++z) {
+        for (int y = lo.y; y <= hi.y; ++y) {
+            size_t cell = cell_index(glm::ivec3(lo.x, y, z));
+            for (int x = lo.x; x <= hi.x; ++x, ++cell) {
+                auto begin = slot_boid_.begin() + cell_start_[cell];
+                found.insert(found.end(), begin, begin + cell_count_[cell]);
+            }
+        }
+    }
+}
+
+void IncrementalGrid::nearest_impl(const glm::vec3& position, const ViewCone& cone, NearestNeighbors& nearest) const {
+    if (cell_of_.empty()) return;
+
+    float radius = std::sqrt(nearest.bound_sq());
+    glm::ivec3 lo = cell_coords(position - glm::vec3(radius));
+    glm::ivec3 hi = cell_coords(position + glm::vec3(radius));
+
+    for (int z = lo.z; z <= hi.z; ++z) {
+        for (int y = lo.y; y <= hi.y; ++y) {
+            for (int x = lo.x; x <= hi.x; ++x) {
+                // Skip cells beyond the current k-th distance.
+                if (cell_distance_sq(glm::ivec3(x, y, z), position) > nearest.bound_sq()) continue;
+
+                size_t cell = cell_index(glm::ivec3(x, y, z));
+                for (size_t slot = cell_start_[cell]; slot < cell_start_[cell] + cell_count_[cell]; ++slot) {
+                    glm::vec3 delta = slot_position_[slot] - position;
+                    float dist_sq = glm::dot(delta, delta);
+                    if (dist_sq <= nearest.bound_sq() && cone.contains(delta)) {
+                        nearest.offer(slot_boid_[slot], dist_sq);
+                    }
+                }
+            }
+        }
+    }
+}
+} // namespace GLOO
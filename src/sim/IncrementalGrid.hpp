@@ -0,0 +1,105 @@
+#ifndef INCREMENTAL_GRID_HPP_
+#define INCREMENTAL_GRID_HPP_
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "FlockState.hpp"
+#include "SpatialIndex.hpp"
+
+namespace GLOO{
+// Uniform grid that is kept across steps instead of rebuilt. Cells are laid
+// out in one flat array like UniformGrid's, but every cell gets some spare
+// slots, and every boid remembers its cell and its slot. update() then only
+// touches boids that crossed a cell boundary: each is swap-removed from its
+// old cell and written to a spare slot of the new one. Boids move a small
+// fraction of a cell per step, so most steps relocate few of them.
+//
+// Slots carry a copy of the boid's position, refreshed by every update(), so
+// queries scan contiguous memory like UniformGrid's sorted_positions_ and
+// are exact as long as update() ran on the current positions. Boids outside
+// the bounds are clamped into the border cells, like UniformGrid.
+class IncrementalGrid : public SpatialIndex {
+public:
+    IncrementalGrid() {}
+
+    // Brings the grid up to date with state. Falls back to a full rebuild
+    // when the bounds, cell size or boid count changed, after invalidate(),
+    // when more than max_moved_fraction of the boids changed cell, or when a
+    // cell runs out of spare slots.
+    void update(glm::vec3 lower_bound, glm::vec3 upper_bound, float cell_size,
+                const FlockState& state, float max_moved_fraction);
+
+    // Forces the next update() to rebuild, e.g. after the state was reordered.
+    void invalidate() {
+        valid_ = false;
+    };
+
+    void query(uint32_t boid, float radius, float view_angle, std::vector<uint32_t>& found) const override;
+
+    // Boids that changed cell in the last update(); all of them on a rebuild.
+    size_t get_relocations() const {
+        return relocations_;
+    };
+    // Whether the last update() rebuilt the grid.
+    bool get_rebuilt() const {
+        return rebuilt_;
+    };
+
+protected:
+    glm::vec3 position_of(uint32_t boid) const override {
+        return state_->position(boid);
+    };
+    glm::vec3 velocity_of(uint32_t boid) const override {
+        return state_->velocity(boid);
+    };
+    void gather_impl(const NeighborGather& gather, std::vector<uint32_t>& close, std::vector<uint32_t>& visible) const override;
+    void candidates_impl(const glm::vec3& position, float radius, std::vector<uint32_t>& found) const override;
+    void nearest_impl(const glm::vec3& position, const ViewCone& cone, NearestNeighbors& nearest) const override;
+
+private:
+    // Lays the cells out again from new_cell_ with fresh spare slots.
+    void rebuild();
+    // Moves boid i to cell to; false if that cell is full.
+    bool relocate(uint32_t i, uint32_t to);
+    glm::ivec3 cell_coords(const glm::vec3& pos) const;
+    // Squared distance from pos to the cell's box.
+    float cell_distance_sq(const glm::ivec3& coords, const glm::vec3& pos) const;
+    size_t cell_index(const glm::ivec3& coords) const {
+        return (static_cast<size_t>(coords.z) * dims_.y + coords.y) * dims_.x + coords.x;
+    };
+    // Calls fn(slot) for every slot, spare ones included, of the cells
+    // overlapping the cube of half size radius around position.
+    template <typename Fn>
+    void for_each_slot(const glm::vec3& position, float radius, Fn fn) const;
+
+    // Same cap as UniformGrid.
+    static const int kMaxCellsPerAxis = 128;
+    // Spare slots per cell on a rebuild: a quarter of its boids, plus a few
+    // so empty cells can take in arrivals too.
+    static const uint32_t kSpareDivisor = 4;
+    static const uint32_t kMinSpare = 4;
+
+    const FlockState* state_ = nullptr;
+    bool valid_ = false;
+    glm::vec3 lower_bound_{0.f};
+    glm::vec3 upper_bound_{0.f};
+    float requested_cell_size_ = 0.f;
+    float cell_size_ = 1.f;
+    glm::ivec3 dims_{0};
+
+    // Cells back to back, each followed by its spare slots.
+    std::vector<uint32_t> slot_boid_;
+    std::vector<glm::vec3> slot_position_;
+    std::vector<uint32_t> cell_start_; // size cells + 1; capacity is the difference
+    std::vector<uint32_t> cell_count_; // boids in each cell
+    std::vector<uint32_t> cell_of_;    // current cell per boid
+    std::vector<uint32_t> slot_of_;    // current slot per boid
+    std::vector<uint32_t> new_cell_;   // scratch for update()
+
+    size_t relocations_ = 0;
+    bool rebuilt_ = false;
+};
+} // namespace GLOO
+
+#endif // INCREMENTAL_GRID_HPP_
@@ -0,0 +1,183 @@
+#include "LinearOctree.hpp"
+#include <chrono>
+#include <algorithm>
+
+namespace GLOO{
+
+namespace {
+inline uint32_t octant_of(const glm::vec3& pos, const glm::vec3& mid) {
+    // bit 0: upper x, bit 1: upper y, bit 2: upper z (same order as QuadTree)
+    return (pos.x >= mid.x ? 1u : 0u) | (pos.y >= mid.y ? 2u : 0u) | (pos.z >= mid.z ? 4u : 0u);
+}
+} // namespace
+
+void LinearOctree::build(glm::vec3 lower_bound, glm::vec3 upper_bound, int leaf_capacity, const FlockState& state) {
+    auto t0 = std::chrono::steady_clock::now();
+
+    state_ = &state;
+    uint32_t n = static_cast<uint32_t>(state.size());
+    uint32_t capacity = static_cast<uint32_t>(std::max(leaf_capacity, 1));
+    arena_.reset();
+    nodes_.clear();
+
+    uint32_t* level = arena_.allocate<uint32_t>(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        level[i] = i;
+        // boxes must contain their boids for query pruning to be exact
+        glm::vec3 pos = state.position(i);
+        lower_bound = glm::min(lower_bound, pos);
+        upper_bound = glm::max(upper_bound, pos);
+    }
+    nodes_.push_back(Node{lower_bound, upper_bound, level, n, 0});
+
+    // Split every overfull node of one level into the next level's buffer.
+    size_t level_begin = 0;
+    size_t level_end = 1;
+    for (int depth = 0; depth < kMaxDepth && level_begin < level_end; ++depth) {
+        uint32_t* next_level = nullptr;
+        uint32_t filled = 0;
+        for (size_t i = level_begin; i < level_end; ++i) {
+            uint32_t count = nodes_[i].count;
+            if (count <= capacity) continue;
+            if (next_level == nullptr) {
+                next_level = arena_.allocate<uint32_t>(n);
+            }
+            split(static_cast<uint32_t>(i), next_level + filled);
+            filled += count;
+        }
+        level_begin = level_end;
+        level_end = nodes_.size();
+    }
+
+    build_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+void LinearOctree::split(uint32_t index, uint32_t* out) {
+    // copy: push_back below may reallocate nodes_
+    Node node = nodes_[index];
+    glm::vec3 mid = (node.lower_bound + node.upper_bound) / 2.0f;
+
+    uint32_t offsets[8] = {0};
+    for (uint32_t i = 0; i < node.count; ++i) {
+        offsets[octant_of(state_->position(node.boids[i]), mid)]++;
+    }
+    uint32_t counts[8];
+    uint32_t sum = 0;
+    for (int o = 0; o < 8; ++o) {
+        counts[o] = offsets[o];
+        offsets[o] = sum;
+        sum += counts[o];
+    }
+    for (uint32_t i = 0; i < node.count; ++i) {
+        uint32_t boid = node.boids[i];
+        out[offsets[octant_of(state_->position(boid), mid)]++] = boid;
+    }
+
+    nodes_[index].first_child = static_cast<uint32_t>(nodes_.size());
+    for (uint32_t o = 0; o < 8; ++o) {
+        glm::vec3 lower(o & 1 ? mid.x : node.lower_bound.x,
+                        o & 2 ? mid.y : node.lower_bound.y,
+                        o & 4 ? mid.z : node.lower_bound.z);
+        glm::vec3 upper(o & 1 ? node.upper_bound.x : mid.x,
+                        o & 2 ? node.upper_bound.y : mid.y,
+                        o & 4 ? node.upper_bound.z : mid.z);
+        // offsets[o] now points at the end of octant o
+        nodes_.push_back(Node{lower, upper, out + offsets[o] - counts[o], counts[o], 0});
+    }
+}
+
+template <typename Fn>
+void LinearOctree::for_each_leaf(const glm::vec3& position, float radius, Fn fn) const {
+    if (nodes_.empty()) return;
+
+    float radius_sq = radius * radius;
+    uint32_t stack[kStackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes_[stack[--top]];
+        glm::vec3 to_node = glm::clamp(position, node.lower_bound, node.upper_bound) - position;
+        if (glm::dot(to_node, to_node) > radius_sq) continue;
+
+        if (node.first_child == 0) {
+            fn(node);
+        } else {
+            for (uint32_t c = 0; c < 8; ++c) {
+                stack[top++] = node.first_child + c;
+            }
+        }
+    }
+}
+
+void LinearOctree::query(uint32_t boid, float radius, float view_angle, std::vector<uint32_t>& found) const {
+    glm::vec3 position = state_->position(boid);
+    ViewCone cone(state_->velocity(boid), view_angle);
+    float radius_sq = radius * radius;
+    for_each_leaf(position, radius, [&](const Node& node) {
+        for (uint32_t i = 0; i < node.count; ++i) {
+            uint32_t other = node.boids[i];
+            glm::vec3 delta = state_->position(other) - position;
+            if (glm::dot(delta, delta) <= radius_sq && cone.contains(delta)) {
+                found.push_back(other);
+            }
+        }
+    });
+}
+
+void LinearOctree::gather_impl(const NeighborGather& gather, std::vector<uint32_t>& close, std::vector<uint32_t>& visible) const {
+    for_each_leaf(gather.position, gather.radius, [&](const Node& node) {
+        for (uint32_t i = 0; i < node.count; ++i) {
+            uint32_t other = node.boids[i];
+            gather.classify(other, state_->position(other), close, visible);
+        }
+    });
+}
+
+void LinearOctree::candidates_impl(const glm::vec3& position, float radius, std::vector<uint32_t>& found) const {
+    for_each_leaf(position, radius, [&](const Node& node) {
+        found.insert(found.end(), node.boids, node.boids + node.count);
+    });
+}
+
+void LinearOctree::nearest_impl(const glm::vec3& position, const ViewCone& cone, NearestNeighbors& nearest) const {
+    if (nodes_.empty()) return;
+
+    uint32_t stack[kStackSize];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes_[stack[--top]];
+        glm::vec3 to_node = glm::clamp(position, node.lower_bound, node.upper_bound) - position;
+        if (glm::dot(to_node, to_node) > nearest.bound_sq()) continue;
+
+        if (node.first_child == 0) {
+            for (uint32_t i = 0; i < node.count; ++i) {
+                uint32_t other = node.boids[i];
+                glm::vec3 delta = state_->position(other) - position;
+                float dist_sq = glm::dot(delta, delta);
+                if (dist_sq <= nearest.bound_sq() && cone.contains(delta)) {
+                    nearest.offer(other, dist_sq);
+                }
+            }
+            continue;
+        }
+
+        // Push the farthest child first so the nearest is popped next and
+        // tightens the bound before the others are visited.
+        float child_dist_sq[8];
+        uint32_t order[8];
+        for (uint32_t c = 0; c < 8; ++c) {
+            const Node& child = nodes_[node.first_child + c];
+            glm::vec3 to_child = glm::clamp(position, child.lower_bound, child.upper_bound) - position;
+            child_dist_sq[c] = glm::dot(to_child, to_child);
+            order[c] = c;
+        }
+        std::sort(order, order + 8, [&](uint32_t a, uint32_t b) {
+            return child_dist_sq[a] > child_dist_sq[b];
+        });
+        for (uint32_t c : order) {
+            stack[top++] = node.first_child + c;
+        }
+    }
+}
+} // namespace GLOO
@@ -0,0 +1,78 @@
+#ifndef LINEAR_OCTREE_HPP_
+#define LINEAR_OCTREE_HPP_
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "FlockState.hpp"
+#include "SpatialIndex.hpp"
+#include "FrameArena.hpp"
+
+namespace GLOO{
+// Octree stored as a flat node array. Nodes refer to their children by index,
+// and the eight children of a node are adjacent. The tree is built top-down
+// one level at a time: each level's boid indices live in one contiguous
+// buffer, split into per-node ranges by a counting sort on the octant. The
+// buffers come from a FrameArena that is reset on rebuild, so a warm rebuild
+// does no heap allocation.
+class LinearOctree : public SpatialIndex {
+public:
+    LinearOctree() {}
+
+    // Rebuilds the tree. Nodes holding more than leaf_capacity boids are
+    // split, down to kMaxDepth levels. The root box is grown to cover boids
+    // outside [lower_bound, upper_bound].
+    void build(glm::vec3 lower_bound, glm::vec3 upper_bound, int leaf_capacity, const FlockState& state);
+
+    void query(uint32_t boid, float radius, float view_angle, std::vector<uint32_t>& found) const override;
+
+    size_t get_node_count() const {
+        return nodes_.size();
+    };
+    // Wall time of the last build().
+    double get_build_ms() const {
+        return build_ms_;
+    };
+
+protected:
+    glm::vec3 position_of(uint32_t boid) const override {
+        return state_->position(boid);
+    };
+    glm::vec3 velocity_of(uint32_t boid) const override {
+        return state_->velocity(boid);
+    };
+    void gather_impl(const NeighborGather& gather, std::vector<uint32_t>& close, std::vector<uint32_t>& visible) const override;
+    void candidates_impl(const glm::vec3& position, float radius, std::vector<uint32_t>& found) const override;
+    void nearest_impl(const glm::vec3& position, const ViewCone& cone, NearestNeighbors& nearest) const override;
+
+private:
+    struct Node {
+        glm::vec3 lower_bound;
+        glm::vec3 upper_bound;
+        // This node's range of its level's boid buffer.
+        const uint32_t* boids;
+        uint32_t count;
+        // Index of the first of eight children, or 0 for a leaf.
+        uint32_t first_child;
+    };
+
+    // Partitions nodes_[index]'s boids by octant into out and appends its
+    // eight children.
+    void split(uint32_t index, uint32_t* out);
+
+    // Calls fn(node) for every leaf whose box is within radius of position.
+    template <typename Fn>
+    void for_each_leaf(const glm::vec3& position, float radius, Fn fn) const;
+
+    static const int kMaxDepth = 8;
+    // Deepest possible traversal stack: each level pops one node and pushes eight.
+    static const int kStackSize = 7 * kMaxDepth + 1;
+
+    const FlockState* state_ = nullptr;
+    std::vector<Node> nodes_;
+    FrameArena arena_;
+    double build_ms_ = 0.0;
+};
+} // namespace GLOO
+
+#endif // LINEAR_OCTREE_HPP_
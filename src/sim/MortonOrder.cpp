@@ -0,0 +1,75 @@
+#include "MortonOrder.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace GLOO{
+
+namespace {
+const int kBitsPerPass = 10;
+const uint32_t kBuckets = 1u << kBitsPerPass;
+const uint32_t kMaxCoord = 1023;
+} // namespace
+
+const std::vector<uint32_t>& MortonOrder::sort(const FlockState& state, const glm::vec3& lower_bound, const glm::vec3& upper_bound) {
+    size_t n = state.size();
+    codes_.resize(n);
+    codes_tmp_.resize(n);
+    order_.resize(n);
+    order_tmp_.resize(n);
+
+    glm::vec3 scale = static_cast<float>(kMaxCoord) / glm::max(upper_bound - lower_bound, glm::vec3(1e-6f));
+    for (size_t i = 0; i < n; ++i) {
+        glm::vec3 q = glm::clamp((state.position(i) - lower_bound) * scale, glm::vec3(0.f), glm::vec3(static_cast<float>(kMaxCoord)));
+        codes_[i] = morton_encode(static_cast<uint32_t>(q.x), static_cast<uint32_t>(q.y), static_cast<uint32_t>(q.z));
+        order_[i] = static_cast<uint32_t>(i);
+    }
+
+    // LSD radix sort, three 10-bit digits.
+    counts_.resize(kBuckets);
+    for (int shift = 0; shift < 30; shift += kBitsPerPass) {
+        std::fill(counts_.begin(), counts_.end(), 0u);
+        for (size_t i = 0; i < n; ++i) {
+            counts_[(codes_[i] >> shift) & (kBuckets - 1)]++;
+        }
+        uint32_t sum = 0;
+        for (uint32_t b = 0; b < kBuckets; ++b) {
+            uint32_t count = counts_[b];
+            counts_[b] = sum;
+            sum += count;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t slot = counts_[(codes_[i] >> shift) & (kBuckets - 1)]++;
+            codes_tmp_[slot] = codes_[i];
+            order_tmp_[slot] = order_[i];
+        }
+        std::swap(codes_, codes_tmp_);
+        std::swap(order_, order_tmp_);
+    }
+    return order_;
+}
+
+void MortonOrder::apply(FlockState& state, FlockState& scratch) const {
+    size_t n = order_.size();
+    scratch.resize(n);
+    for (size_t j = 0; j < n; ++j) {
+        uint32_t i = order_[j];
+        scratch.x[j] = state.x[i];
+        scratch.y[j] = state.y[i];
+        scratch.z[j] = state.z[i];
+        scratch.vx[j] = state.vx[i];
+        scratch.vy[j] = state.vy[i];
+        scratch.vz[j] = state.vz[i];
+        scratch.id[j] = state.id[i];
+        scratch.set_predator(j, state.is_predator(i));
+    }
+    std::swap(state, scratch);
+}
+
+const std::vector<uint32_t>& MortonOrder::inverse() {
+    inverse_.resize(order_.size());
+    for (size_t j = 0; j < order_.size(); ++j) {
+        inverse_[order_[j]] = static_cast<uint32_t>(j);
+    }
+    return inverse_;
+}
+} // namespace GLOO
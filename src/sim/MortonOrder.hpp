@@ -0,0 +1,51 @@
+#ifndef MORTON_ORDER_HPP_
+#define MORTON_ORDER_HPP_
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "FlockState.hpp"
+
+namespace GLOO{
+// Interleaves the low 10 bits of x, y and z into a 30-bit Z-curve code.
+inline uint32_t morton_encode(uint32_t x, uint32_t y, uint32_t z) {
+    struct Spread {
+        static uint32_t bits(uint32_t v) {
+            // 0b1111111111 -> 0b001001...001, two zero bits between each
+            v &= 0x3ff;
+            v = (v | (v << 16)) & 0x030000ff;
+            v = (v | (v << 8)) & 0x0300f00f;
+            v = (v | (v << 4)) & 0x030c30c3;
+            v = (v | (v << 2)) & 0x09249249;
+            return v;
+        }
+    };
+    return Spread::bits(x) | (Spread::bits(y) << 1) | (Spread::bits(z) << 2);
+}
+
+// Orders boids along a Z-curve so boids close in space end up close in
+// memory. Positions are quantized to 1024 steps per axis over the given
+// bounds (clamped outside) and the codes are radix sorted, so sort() is O(n)
+// and stable. Buffers are kept between calls.
+class MortonOrder {
+    public:
+        // Returns order, where order[j] is the index in state of the boid
+        // that belongs at position j.
+        const std::vector<uint32_t>& sort(const FlockState& state, const glm::vec3& lower_bound, const glm::vec3& upper_bound);
+
+        // Moves every per-boid array of state into the order from the last
+        // sort(), using scratch as the destination before swapping.
+        void apply(FlockState& state, FlockState& scratch) const;
+
+        // inverse()[old_index] is the boid's index after apply().
+        const std::vector<uint32_t>& inverse();
+
+    private:
+        std::vector<uint32_t> codes_, codes_tmp_;
+        std::vector<uint32_t> order_, order_tmp_;
+        std::vector<uint32_t> inverse_;
+        std::vector<uint32_t> counts_;
+};
+} // namespace GLOO
+
+#endif // MORTON_ORDER_HPP_
@@ -0,0 +1,65 @@
+#ifndef NEAREST_NEIGHBORS_HPP_
+#define NEAREST_NEIGHBORS_HPP_
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+namespace GLOO{
+// Result of a k-nearest query: a max-heap of at most k (distance, boid)
+// pairs, so the current k-th distance is at the front and a farther
+// candidate is rejected in O(1). Indexes prune anything farther than
+// bound_sq(). Reuse one across queries to keep its storage.
+class NearestNeighbors {
+public:
+    struct Entry {
+        float dist_sq;
+        uint32_t boid;
+
+        bool operator<(const Entry& other) const {
+            return dist_sq < other.dist_sq;
+        };
+    };
+
+    // Empties the heap for a query of the k nearest within radius_sq.
+    void reset(size_t k, float radius_sq) {
+        k_ = k;
+        radius_sq_ = radius_sq;
+        entries_.clear();
+        entries_.reserve(k);
+    };
+
+    // Squared distance a candidate has to beat: the k-th nearest so far,
+    // or the query radius until k have been found.
+    float bound_sq() const {
+        return entries_.size() < k_ ? radius_sq_ : entries_.front().dist_sq;
+    };
+
+    void offer(uint32_t boid, float dist_sq) {
+        if (!(dist_sq <= bound_sq()) || k_ == 0) return;
+        if (entries_.size() == k_) {
+            std::pop_heap(entries_.begin(), entries_.end());
+            entries_.back() = Entry{dist_sq, boid};
+        } else {
+            entries_.push_back(Entry{dist_sq, boid});
+        }
+        std::push_heap(entries_.begin(), entries_.end());
+    };
+
+    // Found neighbors in heap order.
+    const std::vector<Entry>& entries() const {
+        return entries_;
+    };
+    size_t size() const {
+        return entries_.size();
+    };
+
+private:
+    size_t k_ = 0;
+    float radius_sq_ = 0.f;
+    std::vector<Entry> entries_;
+};
+} // namespace GLOO
+
+#endif // NEAREST_NEIGHBORS_HPP_
@@ -0,0 +1,79 @@
+#ifndef NORMAL_SAMPLER_HPP_
+#define NORMAL_SAMPLER_HPP_
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include <random>
+
+namespace GLOO{
+// Normally distributed floats from std::mt19937 through the Box-Muller
+// transform. std::default_random_engine and std::normal_distribution are
+// left to the standard library, so libstdc++, libc++ and MSVC spawn
+// different flocks from the same seed; mt19937's sequence is fixed by the
+// standard and the transform here is plain double arithmetic, so spawn()
+// and the golden hashes built on it are the same everywhere (up to libm
+// rounding of log, cos and sin, which the double precision absorbs).
+class NormalSampler {
+    public:
+        NormalSampler(float mean, float stddev, uint32_t seed)
+            : engine_(seed), mean_(mean), stddev_(stddev) {}
+
+        void seed(uint32_t value) {
+            engine_.seed(value);
+            has_spare_ = false;
+        };
+
+        float operator()() {
+            double z;
+            if (has_spare_) {
+                z = spare_;
+                has_spare_ = false;
+            } else {
+                // u1 in (0, 1] so the log is finite, u2 in [0, 1).
+                double u1 = (static_cast<double>(engine_()) + 1.0) / 4294967296.0;
+                double u2 = static_cast<double>(engine_()) / 4294967296.0;
+                double radius = std::sqrt(-2.0 * std::log(u1));
+                double angle = 6.283185307179586 * u2;
+                z = radius * std::cos(angle);
+                spare_ = radius * std::sin(angle);
+                has_spare_ = true;
+            }
+            return static_cast<float>(mean_ + stddev_ * z);
+        };
+
+        // Text form of the engine and the cached second sample, for
+        // snapshots. The sample is written as its bit pattern so it reads
+        // back exactly.
+        void write(std::ostream& out) const {
+            uint64_t spare_bits;
+            std::memcpy(&spare_bits, &spare_, sizeof(spare_bits));
+            out << engine_ << ' ' << (has_spare_ ? 1 : 0) << ' ' << spare_bits;
+        };
+        // False, leaving the sampler as it was, if in does not hold write()'s
+        // output.
+        bool read(std::istream& in) {
+            std::mt19937 engine;
+            int has_spare = 0;
+            uint64_t spare_bits = 0;
+            if (!(in >> engine >> has_spare >> spare_bits) || (has_spare != 0 && has_spare != 1)) {
+                return false;
+            }
+            engine_ = engine;
+            has_spare_ = has_spare == 1;
+            std::memcpy(&spare_, &spare_bits, sizeof(spare_));
+            return true;
+        };
+
+    private:
+        std::mt19937 engine_;
+        double mean_;
+        double stddev_;
+        double spare_ = 0.0;
+        bool has_spare_ = false;
+};
+} // namespace GLOO
+
+#endif // NORMAL_SAMPLER_HPP_
@@ -0,0 +1,91 @@
+#include "Profiler.hpp"
+
+#ifdef BOIDS_PROFILING
+
+#include <algorithm>
+#include <cmath>
+
+namespace GLOO{
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+int Profiler::begin_zone(const char* name) {
+    if (!has_owner_) {
+        owner_ = std::this_thread::get_id();
+        has_owner_ = true;
+    } else if (std::this_thread::get_id() != owner_) {
+        return -1;
+    }
+
+    int parent = stack_.empty() ? -1 : stack_.back();
+    int zone = -1;
+    for (size_t i = 0; i < zones_.size(); ++i) {
+        if (zones_[i].parent == parent && zones_[i].name == name) {
+            zone = static_cast<int>(i);
+            break;
+        }
+    }
+    if (zone < 0) {
+        int depth = parent < 0 ? 0 : zones_[parent].depth + 1;
+        zones_.push_back(Zone{name, parent, depth, 0.0, false, std::vector<float>(kHistoryFrames, -1.f)});
+        zone = static_cast<int>(zones_.size() - 1);
+
+        // Insert after the parent's last descendant to keep order_ depth-first.
+        size_t at = order_.size();
+        if (parent >= 0) {
+            at = std::find(order_.begin(), order_.end(), static_cast<size_t>(parent)) - order_.begin() + 1;
+            while (at < order_.size() && zones_[order_[at]].depth > zones_[parent].depth) {
+                ++at;
+            }
+        }
+        order_.insert(order_.begin() + at, static_cast<size_t>(zone));
+    }
+    stack_.push_back(zone);
+    return zone;
+}
+
+void Profiler::end_zone(int zone, double ms) {
+    zones_[zone].frame_ms += ms;
+    zones_[zone].ran = true;
+    stack_.pop_back();
+}
+
+void Profiler::end_frame() {
+    if (has_owner_ && std::this_thread::get_id() != owner_) return;
+    size_t slot = frame_ % kHistoryFrames;
+    for (Zone& zone : zones_) {
+        zone.history[slot] = zone.ran ? static_cast<float>(zone.frame_ms) : -1.f;
+        zone.frame_ms = 0.0;
+        zone.ran = false;
+    }
+    ++frame_;
+}
+
+Profiler::ZoneStats Profiler::stats(size_t i) const {
+    const Zone& zone = this->zone(i);
+    std::vector<float> samples;
+    samples.reserve(kHistoryFrames);
+    for (float ms : zone.history) {
+        if (ms >= 0.f) samples.push_back(ms);
+    }
+
+    ZoneStats stats;
+    stats.frames = samples.size();
+    if (samples.empty()) return stats;
+    double sum = 0.0;
+    for (float ms : samples) {
+        sum += ms;
+    }
+    stats.avg_ms = sum / samples.size();
+    stats.min_ms = *std::min_element(samples.begin(), samples.end());
+    size_t rank = static_cast<size_t>(std::ceil(0.99 * samples.size())) - 1;
+    std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    stats.p99_ms = samples[rank];
+    return stats;
+}
+} // namespace GLOO
+
+#endif // BOIDS_PROFILING
@@ -0,0 +1,128 @@
+#ifndef PROFILER_HPP_
+#define PROFILER_HPP_
+
+// Frame profiler with nested zones. Mark code with PROFILE_SCOPE("name") and
+// close each frame with PROFILE_FRAME(); the per-frame time of every zone is
+// kept for the last kHistoryFrames frames. Zones are keyed by name and
+// parent zone, so the same scope reached through different callers shows up
+// under each of them.
+//
+// Only the first thread to open a zone records; scopes on other threads
+// (thread pool workers) are ignored here, but every scope on every thread
+// goes to the TraceWriter while it is recording. The profiler lives in flocksim because
+// that library is GL-free and linked into every target, so the simulation,
+// the engine and the tools can all use it.
+//
+// Built only with BOIDS_PROFILING defined (CMake option
+// BOIDS_ENABLE_PROFILER); otherwise the macros expand to nothing and none of
+// the code below exists.
+
+#ifdef BOIDS_PROFILING
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include "TraceWriter.hpp"
+
+namespace GLOO{
+class Profiler {
+    public:
+        static const size_t kHistoryFrames = 240;
+
+        struct Zone {
+            std::string name;
+            int parent;
+            int depth;
+            // Time accumulated in the current frame, and per frame for the
+            // last kHistoryFrames frames; -1 marks frames the zone did not run.
+            double frame_ms;
+            bool ran;
+            std::vector<float> history;
+        };
+
+        // Over the frames in the history in which the zone ran.
+        struct ZoneStats {
+            double min_ms = 0.0;
+            double avg_ms = 0.0;
+            double p99_ms = 0.0;
+            size_t frames = 0;
+        };
+
+        static Profiler& instance();
+
+        // Opens a child zone of the innermost open zone; returns its id, or
+        // -1 on threads that do not record.
+        int begin_zone(const char* name);
+        void end_zone(int zone, double ms);
+        // Moves this frame's times into the history.
+        void end_frame();
+
+        size_t zone_count() const {
+            return zones_.size();
+        };
+        // Zones are ordered depth-first, children after their parent.
+        const Zone& zone(size_t i) const {
+            return zones_[order_[i]];
+        };
+        ZoneStats stats(size_t i) const;
+        uint64_t get_frame_count() const {
+            return frame_;
+        };
+
+    private:
+        Profiler() {}
+
+        std::thread::id owner_;
+        bool has_owner_ = false;
+        std::vector<Zone> zones_;
+        // zones_ indices in depth-first order, for display.
+        std::vector<size_t> order_;
+        std::vector<int> stack_;
+        uint64_t frame_ = 0;
+};
+
+// Times its own lifetime into a zone, and into the trace if one is being
+// recorded when the scope opens.
+class ProfileScope {
+    public:
+        explicit ProfileScope(const char* name)
+            : name_(name),
+              traced_(TraceWriter::instance().is_recording()),
+              zone_(Profiler::instance().begin_zone(name)),
+              start_(std::chrono::steady_clock::now()) {
+            if (traced_) TraceWriter::instance().begin(name_, start_);
+        }
+        ~ProfileScope() {
+            auto end = std::chrono::steady_clock::now();
+            if (traced_) TraceWriter::instance().end(name_, end);
+            if (zone_ < 0) return;
+            Profiler::instance().end_zone(zone_, std::chrono::duration<double, std::milli>(end - start_).count());
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        const char* name_;
+        bool traced_;
+        int zone_;
+        std::chrono::steady_clock::time_point start_;
+};
+} // namespace GLOO
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(name) ::GLOO::ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#define PROFILE_FRAME() ::GLOO::Profiler::instance().end_frame()
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+
+#endif // BOIDS_PROFILING
+
+#endif // PROFILER_HPP_
@@ -0,0 +1,237 @@
+#ifndef QUADTREE_HPP_
+#define QUADTREE_HPP_
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "FlockState.hpp"
+#include "SpatialIndex.hpp"
+
+namespace GLOO{
+class QuadTree : public SpatialIndex {
+public:
+    // Empty node over the same state, used for children
+    QuadTree(glm::vec3 lower_bound, glm::vec3 upper_bound, int capacity, const FlockState* state)
+        : state_(state), lower_bound_(lower_bound), upper_bound_(upper_bound), capacity_(capacity) {}
+
+    // Root node holding every boid in state
+    QuadTree(glm::vec3 lower_bound, glm::vec3 upper_bound, int capacity, const FlockState& state)
+        : QuadTree(lower_bound, upper_bound, capacity, &state) {
+            for (uint32_t i = 0; i < state.size(); ++i) {
+                insert(i);
+            }
+    }
+
+    // Add member functions and variables here
+    void subdivide() {
+
+        if (max_depth-- <= 0) return;
+        // Implement subdivision logic here
+        if (divided_) return;
+        divided_ = true;
+        // Create child QuadTrees (8 octants) and store them in children_
+        glm::vec3 mid = (lower_bound_ + upper_bound_) / 2.0f;
+        children_.clear();
+        children_.reserve(8);
+
+        // Lower Z half
+        // 0: (low,low,low) -> (mid,mid,mid)
+        children_.push_back(std::unique_ptr<QuadTree>(new QuadTree(
+            lower_bound_, mid, capacity_, state_)));
+        // 1: (mid.x, low.y, low.z) -> (high.x, mid.y, mid.z)
+        children_.push_back(std::unique_ptr<QuadTree>(new QuadTree(
+            glm::vec3(mid.x, lower_bound_.y, lower_bound_.z),
+            glm::vec3(upper_bound_.x, mid.y, mid.z), capacity_, state_)));
+        // 2: (low.x, mid.y, low.z) -> (mid.x, high.y, mid.z)
+        children_.push_back(std::unique_ptr<QuadTree>(new QuadTree(
+            glm::vec3(lower_bound_.x, mid.y, lower_bound_.z),
+            glm::vec3(mid.x, upper_bound_.y, mid.z), capacity_, state_)));
+        // 3: (mid.x, mid.y, low.z) -> (high.x, high.y, mid.z)
+        children_.push_back(std::unique_ptr<QuadTree>(new QuadTree(
+            glm::vec3(mid.x, mid.y, lower_bound_.z),
+            glm::vec3(upper_bound_.x, upper_bound_.y, mid.z), capacity_, state_)));
+
+        // Upper Z half
+        // 4: (low.x, low.y, mid.z) -> (mid.x, mid.y, high.z)
+        children_.push_back(std::unique_ptr<QuadTree>(new QuadTree(
+            glm::vec3(lower_bound_.x, lower_bound_.y, mid.z),
+            glm::vec3(mid.x, mid.y, upper_bound_.z), capacity_, state_)));
+        // 5: (mid.x, low.y, mid.z) -> (high.x, mid.y, high.z)
+        children_.push_back(std::unique_ptr<QuadTree>(new QuadTree(
+            glm::vec3(mid.x, lower_bound_.y, mid.z),
+            glm::vec3(upper_bound_.x, mid.y, upper_bound_.z), capacity_, state_)));
+        // 6: (low.x, mid.y, mid.z) -> (mid.x, high.y, high.z)
+        children_.push_back(std::unique_ptr<QuadTree>(new QuadTree(
+            glm::vec3(lower_bound_.x, mid.y, mid.z),
+            glm::vec3(mid.x, upper_bound_.y, upper_bound_.z), capacity_, state_)));
+        // 7: (mid.x, mid.y, mid.z) -> (high.x, high.y, high.z)
+        children_.push_back(std::unique_ptr<QuadTree>(new QuadTree(
+            glm::vec3(mid.x, mid.y, mid.z),
+            upper_bound_, capacity_, state_)));
+
+    }
+
+    void insert(uint32_t boid) {
+        // Implement insertion logic here
+        glm::vec3 pos = state_->position(boid);
+        if (pos.x < lower_bound_.x || pos.x > upper_bound_.x ||
+            pos.y < lower_bound_.y || pos.y > upper_bound_.y ||
+            pos.z < lower_bound_.z || pos.z > upper_bound_.z) {
+            return; // Out of bounds
+        }
+        if (boids_.size() < capacity_) {
+            boids_.push_back(boid);
+        } else {
+            if (!divided_) {
+                subdivide();
+            }
+            for (auto& child : children_) {
+                child->insert(boid);
+            }
+
+            // move existing boids to children
+
+            for (auto it = boids_.begin(); it != boids_.end(); ) {
+                bool inserted = false;
+                for (auto& child : children_) {
+                    glm::vec3 bpos = state_->position(*it);
+                    if (bpos.x >= child->lower_bound_.x && bpos.x <= child->upper_bound_.x &&
+                        bpos.y >= child->lower_bound_.y && bpos.y <= child->upper_bound_.y &&
+                        bpos.z >= child->lower_bound_.z && bpos.z <= child->upper_bound_.z) {
+                        child->insert(*it);
+                        it = boids_.erase(it);
+                        inserted = true;
+                        break;
+                    }
+                }
+                if (!inserted) {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    void query(uint32_t boid, float radius, float view_angle, std::vector<uint32_t>& found) const override {
+        query_cone(state_->position(boid), radius * radius, ViewCone(state_->velocity(boid), view_angle), found);
+    }
+
+
+    // Nodes in this subtree, including this one.
+    size_t node_count() const {
+        size_t count = 1;
+        for (auto& child : children_) {
+            count += child->node_count();
+        }
+        return count;
+    }
+
+protected:
+    glm::vec3 position_of(uint32_t boid) const override {
+        return state_->position(boid);
+    }
+
+    glm::vec3 velocity_of(uint32_t boid) const override {
+        return state_->velocity(boid);
+    }
+
+    void gather_impl(const NeighborGather& gather, std::vector<uint32_t>& close, std::vector<uint32_t>& visible) const override {
+        // Same pruning as query, at the combined radius
+        glm::vec3 closest_point = glm::clamp(gather.position, lower_bound_, upper_bound_);
+        glm::vec3 to_node = closest_point - gather.position;
+        if (glm::dot(to_node, to_node) > gather.radius * gather.radius) {
+            return;
+        }
+
+        for (uint32_t other_boid : boids_) {
+            gather.classify(other_boid, state_->position(other_boid), close, visible);
+        }
+        if (divided_) {
+            for (auto& child : children_) {
+                child->gather_impl(gather, close, visible);
+            }
+        }
+    }
+
+    void candidates_impl(const glm::vec3& position, float radius, std::vector<uint32_t>& found) const override {
+        glm::vec3 to_node = glm::clamp(position, lower_bound_, upper_bound_) - position;
+        if (glm::dot(to_node, to_node) > radius * radius) {
+            return;
+        }
+
+        found.insert(found.end(), boids_.begin(), boids_.end());
+        if (divided_) {
+            for (auto& child : children_) {
+                child->candidates_impl(position, radius, found);
+            }
+        }
+    }
+
+    void nearest_impl(const glm::vec3& position, const ViewCone& cone, NearestNeighbors& nearest) const override {
+        glm::vec3 to_node = glm::clamp(position, lower_bound_, upper_bound_) - position;
+        if (glm::dot(to_node, to_node) > nearest.bound_sq()) {
+            return;
+        }
+
+        for (uint32_t other_boid : boids_) {
+            glm::vec3 delta = state_->position(other_boid) - position;
+            float dist_sq = glm::dot(delta, delta);
+            if (dist_sq <= nearest.bound_sq() && cone.contains(delta)) {
+                nearest.offer(other_boid, dist_sq);
+            }
+        }
+        if (divided_) {
+            // Nearest octants first, so the bound shrinks before the far ones.
+            float child_dist_sq[8];
+            int order[8];
+            for (int c = 0; c < 8; ++c) {
+                glm::vec3 to_child = glm::clamp(position, children_[c]->lower_bound_, children_[c]->upper_bound_) - position;
+                child_dist_sq[c] = glm::dot(to_child, to_child);
+                order[c] = c;
+            }
+            std::sort(order, order + 8, [&](int a, int b) {
+                return child_dist_sq[a] < child_dist_sq[b];
+            });
+            for (int c : order) {
+                children_[c]->nearest_impl(position, cone, nearest);
+            }
+        }
+    }
+
+private:
+    // query() below the root, with the view cone built once by the caller.
+    void query_cone(const glm::vec3& boid_pos, float radius_sq, const ViewCone& cone, std::vector<uint32_t>& found) const {
+        // If node is out of sphere range, return
+        glm::vec3 closest_point = glm::clamp(boid_pos, lower_bound_, upper_bound_);
+        float distance_sq = glm::dot((closest_point - boid_pos), (closest_point - boid_pos));
+        if (distance_sq > radius_sq) {
+            return;
+        }
+
+        for (uint32_t other_boid : boids_) {
+            glm::vec3 delta = state_->position(other_boid) - boid_pos;
+            if (glm::dot(delta, delta) <= radius_sq && cone.contains(delta)) {
+                found.push_back(other_boid);
+            }
+        }
+        if (divided_) {
+            for (auto& child : children_) {
+                child->query_cone(boid_pos, radius_sq, cone, found);
+            }
+        }
+    }
+
+    // Add private member variables here
+    const FlockState* state_;
+    std::vector<uint32_t> boids_;
+    std::vector<std::unique_ptr<QuadTree>> children_;
+    glm::vec3 lower_bound_;
+    glm::vec3 upper_bound_;
+    uint64_t capacity_;
+    bool divided_ = false;
+    int max_depth = 8;
+};
+} // namespace GLOO
+
+#endif // QUADTREE_HPP_
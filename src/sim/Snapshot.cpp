@@ -0,0 +1,144 @@
+#include "Snapshot.hpp"
+#include <cstdio>
+#include <cstring>
+
+namespace GLOO{
+
+namespace {
+const char kMagic[8] = {'B', 'O', 'I', 'D', 'S', 'N', 'P', '\0'};
+// Version 2 stores NormalSampler's state in place of the library engine's.
+const uint32_t kVersion = 2;
+// FlockSimulation::step() reads params_[0] through params_[8].
+const uint32_t kMinParamCount = 9;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t boid_count;
+    uint32_t param_count;
+    uint32_t rng_bytes;
+    uint64_t step_count;
+    float lower_bounds[3];
+    float upper_bounds[3];
+    float margin;
+    float time_step_size;
+    int32_t controlled_predator;
+    uint32_t reserved;
+};
+
+template <typename T>
+bool write_array(FILE* file, const std::vector<T>& values) {
+    return values.empty() || std::fwrite(values.data(), sizeof(T), values.size(), file) == values.size();
+}
+
+template <typename T>
+bool read_array(FILE* file, std::vector<T>& values, size_t count) {
+    values.resize(count);
+    return count == 0 || std::fread(values.data(), sizeof(T), count, file) == count;
+}
+} // namespace
+
+bool write_snapshot(const FlockSnapshot& snapshot, const std::string& path) {
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) return false;
+
+    const FlockState& state = snapshot.state;
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.boid_count = static_cast<uint32_t>(state.size());
+    header.param_count = static_cast<uint32_t>(snapshot.params.size());
+    header.rng_bytes = static_cast<uint32_t>(snapshot.rng_state.size());
+    header.step_count = snapshot.step_count;
+    for (int c = 0; c < 3; ++c) {
+        header.lower_bounds[c] = snapshot.lower_bounds[c];
+        header.upper_bounds[c] = snapshot.upper_bounds[c];
+    }
+    header.margin = snapshot.margin;
+    header.time_step_size = snapshot.time_step_size;
+    header.controlled_predator = snapshot.controlled_predator;
+
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+              write_array(file, snapshot.params) &&
+              std::fwrite(snapshot.rng_state.data(), 1, snapshot.rng_state.size(), file) == snapshot.rng_state.size() &&
+              write_array(file, state.x) && write_array(file, state.y) && write_array(file, state.z) &&
+              write_array(file, state.vx) && write_array(file, state.vy) && write_array(file, state.vz) &&
+              write_array(file, state.predator_bits) && write_array(file, state.id);
+    return std::fclose(file) == 0 && ok;
+}
+
+bool read_snapshot(const std::string& path, FlockSnapshot& snapshot) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) return false;
+
+    // The counts in the header size every allocation below, so they are
+    // checked against the file's length before anything is resized.
+    long file_size = -1;
+    if (std::fseek(file, 0, SEEK_END) == 0) {
+        file_size = std::ftell(file);
+    }
+    SnapshotHeader header;
+    bool ok = file_size >= 0 && std::fseek(file, 0, SEEK_SET) == 0 &&
+              std::fread(&header, sizeof(header), 1, file) == 1 &&
+              std::memcmp(header.magic, kMagic, sizeof(kMagic)) == 0 && header.version == kVersion &&
+              header.param_count >= kMinParamCount && header.controlled_predator >= -1;
+    if (ok) {
+        uint64_t n = header.boid_count;
+        uint64_t expected_size = sizeof(header) + uint64_t(header.param_count) * sizeof(float) + header.rng_bytes +
+                                 n * (6 * sizeof(float) + sizeof(uint32_t)) + (n + 63) / 64 * sizeof(uint64_t);
+        ok = expected_size == static_cast<uint64_t>(file_size);
+    }
+    if (ok) {
+        size_t n = header.boid_count;
+        FlockState& state = snapshot.state;
+        snapshot.rng_state.resize(header.rng_bytes);
+        ok = read_array(file, snapshot.params, header.param_count) &&
+             (header.rng_bytes == 0 ||
+              std::fread(&snapshot.rng_state[0], 1, header.rng_bytes, file) == header.rng_bytes) &&
+             read_array(file, state.x, n) && read_array(file, state.y, n) && read_array(file, state.z, n) &&
+             read_array(file, state.vx, n) && read_array(file, state.vy, n) && read_array(file, state.vz, n) &&
+             read_array(file, state.predator_bits, (n + 63) / 64) && read_array(file, state.id, n);
+        snapshot.step_count = header.step_count;
+        snapshot.lower_bounds = glm::vec3(header.lower_bounds[0], header.lower_bounds[1], header.lower_bounds[2]);
+        snapshot.upper_bounds = glm::vec3(header.upper_bounds[0], header.upper_bounds[1], header.upper_bounds[2]);
+        snapshot.margin = header.margin;
+        snapshot.time_step_size = header.time_step_size;
+        snapshot.controlled_predator = header.controlled_predator;
+        ok = ok && header.controlled_predator < static_cast<int32_t>(n);
+        // Ids must be a permutation of 0..n-1; hash_state() and the
+        // checkpoints index by them.
+        std::vector<bool> seen(ok ? n : 0, false);
+        for (size_t i = 0; ok && i < n; ++i) {
+            ok = state.id[i] < n && !seen[state.id[i]];
+            if (ok) seen[state.id[i]] = true;
+        }
+    }
+    std::fclose(file);
+    return ok;
+}
+
+uint64_t hash_state(const FlockState& state) {
+    size_t n = state.size();
+    std::vector<uint32_t> slot_of_id(n);
+    for (size_t i = 0; i < n; ++i) {
+        slot_of_id[state.id[i]] = static_cast<uint32_t>(i);
+    }
+
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t k = 0; k < size; ++k) {
+            hash = (hash ^ bytes[k]) * 1099511628211ull;
+        }
+    };
+    for (size_t id = 0; id < n; ++id) {
+        size_t i = slot_of_id[id];
+        float values[6] = {state.x[i], state.y[i], state.z[i], state.vx[i], state.vy[i], state.vz[i]};
+        unsigned char predator = state.is_predator(i) ? 1 : 0;
+        mix(values, sizeof(values));
+        mix(&predator, sizeof(predator));
+    }
+    return hash;
+}
+} // namespace GLOO
@@ -0,0 +1,52 @@
+#ifndef SNAPSHOT_HPP_
+#define SNAPSHOT_HPP_
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "FlockState.hpp"
+
+namespace GLOO{
+// Everything a FlockSimulation's future steps depend on besides its run
+// settings, from FlockSimulation::save(). Restoring it with
+// FlockSimulation::restore() continues the run bit for bit, so several
+// what-if runs can fork from one warmed-up state. Run settings (index type,
+// steering kernel, threads, reorder interval and so on) are deliberately
+// left out: they are what the forks vary.
+//
+// The incremental grid and Verlet lists are rebuilt after a restore rather
+// than saved. Their neighbor order depends on when they were built, so
+// FlockSimulation::restore() refuses them unless deterministic_ is set, which
+// sums neighbors in id order; the indexes rebuilt every step resume exactly
+// either way.
+struct FlockSnapshot {
+    FlockState state;
+    std::vector<float> params;
+    glm::vec3 lower_bounds{0.f};
+    glm::vec3 upper_bounds{0.f};
+    float margin = 0.f;
+    float time_step_size = 0.f;
+    uint64_t step_count = 0;
+    int controlled_predator = -1;
+    // Spawn generator, as NormalSampler::write() puts it; the sampler
+    // caches a value between draws, so that is part of the state.
+    std::string rng_state;
+};
+
+// Binary snapshot files: a fixed header, the params and RNG text, then each
+// FlockState array back to back, so reading is one fread per array straight
+// into the vectors restore() will take over. Host byte order.
+bool write_snapshot(const FlockSnapshot& snapshot, const std::string& path);
+// False if the file is missing, truncated or not a snapshot, or if its
+// header or ids are inconsistent (too few params, sizes that disagree with
+// the file's length, ids that are not a permutation).
+bool read_snapshot(const std::string& path, FlockSnapshot& snapshot);
+
+// FNV-1a hash of every boid's position, velocity and predator flag, taken
+// in id order so it does not depend on how the state is sorted. Compares
+// runs bit for bit, e.g. against a golden value in deterministic mode.
+uint64_t hash_state(const FlockState& state);
+} // namespace GLOO
+
+#endif // SNAPSHOT_HPP_
@@ -0,0 +1,98 @@
+#ifndef SPATIAL_INDEX_HPP_
+#define SPATIAL_INDEX_HPP_
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "ViewCone.hpp"
+#include "NearestNeighbors.hpp"
+
+namespace GLOO{
+// Which neighbor index FlockNode rebuilds every frame.
+enum class SpatialIndexType {
+    QuadTree,
+    UniformGrid,
+    LinearOctree,
+    IncrementalGrid
+};
+
+// One boid's combined close/visible neighbor search. The index visits every
+// candidate within radius once and classify() sorts it into the close list
+// (inside close range, any direction) and/or the visible list (inside
+// visible range and the view cone).
+struct NeighborGather {
+    NeighborGather(const glm::vec3& position, const glm::vec3& velocity,
+                   float close_radius, float visible_radius, float view_angle)
+        : position(position), cone(velocity, view_angle),
+          close_sq(close_radius * close_radius), visible_sq(visible_radius * visible_radius),
+          radius(std::max(close_radius, visible_radius)) {}
+
+    void classify(uint32_t other, const glm::vec3& other_position,
+                  std::vector<uint32_t>& close, std::vector<uint32_t>& visible) const {
+        glm::vec3 delta = other_position - position;
+        float dist_sq = glm::dot(delta, delta);
+        if (dist_sq <= close_sq) {
+            close.push_back(other);
+        }
+        if (dist_sq <= visible_sq && cone.contains(delta)) {
+            visible.push_back(other);
+        }
+    }
+
+    glm::vec3 position;
+    ViewCone cone;
+    float close_sq;
+    float visible_sq;
+    // Search radius covering both lists.
+    float radius;
+};
+
+// Common query contract shared by QuadTree and UniformGrid so FlockNode can
+// switch between them at runtime.
+class SpatialIndex {
+public:
+    virtual ~SpatialIndex() {}
+
+    // Appends the index of every boid within radius of boid whose direction
+    // lies inside the boid's view cone (view_angle >= 6.28 disables the angle
+    // check). Indices refer to the FlockState the index was built from.
+    virtual void query(uint32_t boid, float radius, float view_angle, std::vector<uint32_t>& found) const = 0;
+
+    // Fills close and visible for boid in a single traversal at the larger of
+    // the two radii. Both lists are cleared first.
+    void gather(uint32_t boid, float close_radius, float visible_radius, float view_angle,
+                std::vector<uint32_t>& close, std::vector<uint32_t>& visible) const {
+        close.clear();
+        visible.clear();
+        gather_impl(NeighborGather(position_of(boid), velocity_of(boid), close_radius, visible_radius, view_angle), close, visible);
+    }
+
+    // Fills found with every boid in the cells or leaves that come within
+    // radius of boid, without any distance or angle test: a superset for
+    // kernels that apply those tests themselves. found is cleared first.
+    void candidates(uint32_t boid, float radius, std::vector<uint32_t>& found) const {
+        found.clear();
+        candidates_impl(position_of(boid), radius, found);
+    }
+
+    // Fills nearest with the k boids closest to boid that lie within radius
+    // and inside its view cone. The boid itself is found at distance 0, as
+    // in query(), so it takes one of the k places. Subtrees and cells
+    // farther than the current k-th distance are skipped.
+    void nearest(uint32_t boid, size_t k, float radius, float view_angle, NearestNeighbors& nearest) const {
+        nearest.reset(k, radius * radius);
+        if (k == 0) return;
+        nearest_impl(position_of(boid), ViewCone(velocity_of(boid), view_angle), nearest);
+    }
+
+protected:
+    virtual glm::vec3 position_of(uint32_t boid) const = 0;
+    virtual glm::vec3 velocity_of(uint32_t boid) const = 0;
+    virtual void gather_impl(const NeighborGather& gather, std::vector<uint32_t>& close, std::vector<uint32_t>& visible) const = 0;
+    virtual void candidates_impl(const glm::vec3& position, float radius, std::vector<uint32_t>& found) const = 0;
+    virtual void nearest_impl(const glm::vec3& position, const ViewCone& cone, NearestNeighbors& nearest) const = 0;
+};
+} // namespace GLOO
+
+#endif // SPATIAL_INDEX_HPP_
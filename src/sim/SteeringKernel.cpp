@@ -0,0 +1,290 @@
+#include "SteeringKernel.hpp"
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define STEERING_KERNEL_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC compiles AVX intrinsics without per-function target flags.
+#define STEERING_TARGET_AVX2
+#else
+#define STEERING_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace GLOO{
+
+namespace {
+SteeringSums accumulate_scalar(const SteeringQuery& q, const NeighborBlock& block) {
+    SteeringSums sums;
+    for (size_t i = 0; i < block.count; ++i) {
+        glm::vec3 other(block.x[i], block.y[i], block.z[i]);
+        glm::vec3 delta = other - q.position;
+        float dist_sq = glm::dot(delta, delta);
+
+        if (q.separate && dist_sq <= q.close_sq) {
+            float weight = 1.f + block.predator[i] * q.predator_weight;
+            sums.separation += (q.position - other) * weight;
+            sums.close_count++;
+        }
+
+        if (dist_sq <= q.visible_sq && q.cone.contains(delta)) {
+            sums.alignment += glm::vec3(block.vx[i], block.vy[i], block.vz[i]);
+            sums.cohesion += other;
+            sums.visible_count++;
+        }
+    }
+    return sums;
+}
+
+#ifdef STEERING_KERNEL_X86
+inline int popcount(int mask) {
+    int count = 0;
+    for (; mask != 0; mask &= mask - 1) ++count;
+    return count;
+}
+
+inline float horizontal_sum(__m128 v) {
+    __m128 shuffled = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+    __m128 sums = _mm_add_ps(v, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, sums);
+    return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+}
+
+SteeringSums accumulate_sse(const SteeringQuery& q, const NeighborBlock& block) {
+    const __m128 px = _mm_set1_ps(q.position.x);
+    const __m128 py = _mm_set1_ps(q.position.y);
+    const __m128 pz = _mm_set1_ps(q.position.z);
+    const __m128 dir_x = _mm_set1_ps(q.cone.direction.x);
+    const __m128 dir_y = _mm_set1_ps(q.cone.direction.y);
+    const __m128 dir_z = _mm_set1_ps(q.cone.direction.z);
+    const __m128 close_sq = _mm_set1_ps(q.close_sq);
+    const __m128 visible_sq = _mm_set1_ps(q.visible_sq);
+    const __m128 cos_half_sq = _mm_set1_ps(q.cone.cos_half_sq);
+    const __m128 one = _mm_set1_ps(1.f);
+    const __m128 predator_weight = _mm_set1_ps(q.predator_weight);
+    const __m128 separate = _mm_castsi128_ps(_mm_set1_epi32(q.separate ? -1 : 0));
+    const __m128 wide = _mm_castsi128_ps(_mm_set1_epi32(q.cone.wide ? -1 : 0));
+    const __m128 full_circle = _mm_castsi128_ps(_mm_set1_epi32(q.cone.full_circle ? -1 : 0));
+
+    __m128 sep_x = _mm_setzero_ps(), sep_y = _mm_setzero_ps(), sep_z = _mm_setzero_ps();
+    __m128 ali_x = _mm_setzero_ps(), ali_y = _mm_setzero_ps(), ali_z = _mm_setzero_ps();
+    __m128 coh_x = _mm_setzero_ps(), coh_y = _mm_setzero_ps(), coh_z = _mm_setzero_ps();
+    int close_count = 0;
+    int visible_count = 0;
+
+    for (size_t i = 0; i < block.count; i += 4) {
+        __m128 ox = _mm_loadu_ps(&block.x[i]);
+        __m128 oy = _mm_loadu_ps(&block.y[i]);
+        __m128 oz = _mm_loadu_ps(&block.z[i]);
+        __m128 dx = _mm_sub_ps(ox, px);
+        __m128 dy = _mm_sub_ps(oy, py);
+        __m128 dz = _mm_sub_ps(oz, pz);
+        __m128 dist_sq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+
+        __m128 close = _mm_and_ps(_mm_cmple_ps(dist_sq, close_sq), separate);
+        __m128 facing = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dir_x, dx), _mm_mul_ps(dir_y, dy)), _mm_mul_ps(dir_z, dz));
+        // ViewCone::contains, lane by lane; the NLT/NGT compares are true
+        // for NaNs just like its negated comparisons.
+        __m128 facing_sq = _mm_mul_ps(facing, facing);
+        __m128 edge_sq = _mm_mul_ps(cos_half_sq, dist_sq);
+        __m128 in_front = _mm_cmpnlt_ps(facing, _mm_setzero_ps());
+        __m128 in_wide = _mm_or_ps(in_front, _mm_cmpngt_ps(facing_sq, edge_sq));
+        __m128 in_narrow = _mm_and_ps(in_front, _mm_cmpnlt_ps(facing_sq, edge_sq));
+        __m128 in_view = _mm_or_ps(_mm_or_ps(_mm_and_ps(wide, in_wide), _mm_andnot_ps(wide, in_narrow)), full_circle);
+        __m128 visible = _mm_and_ps(_mm_cmple_ps(dist_sq, visible_sq), in_view);
+
+        // (position - other) * weight == -delta * weight
+        __m128 weight = _mm_add_ps(one, _mm_mul_ps(_mm_loadu_ps(&block.predator[i]), predator_weight));
+        __m128 neg_weight = _mm_and_ps(close, _mm_sub_ps(_mm_setzero_ps(), weight));
+        sep_x = _mm_add_ps(sep_x, _mm_mul_ps(dx, neg_weight));
+        sep_y = _mm_add_ps(sep_y, _mm_mul_ps(dy, neg_weight));
+        sep_z = _mm_add_ps(sep_z, _mm_mul_ps(dz, neg_weight));
+
+        ali_x = _mm_add_ps(ali_x, _mm_and_ps(visible, _mm_loadu_ps(&block.vx[i])));
+        ali_y = _mm_add_ps(ali_y, _mm_and_ps(visible, _mm_loadu_ps(&block.vy[i])));
+        ali_z = _mm_add_ps(ali_z, _mm_and_ps(visible, _mm_loadu_ps(&block.vz[i])));
+        coh_x = _mm_add_ps(coh_x, _mm_and_ps(visible, ox));
+        coh_y = _mm_add_ps(coh_y, _mm_and_ps(visible, oy));
+        coh_z = _mm_add_ps(coh_z, _mm_and_ps(visible, oz));
+
+        close_count += popcount(_mm_movemask_ps(close));
+        visible_count += popcount(_mm_movemask_ps(visible));
+    }
+
+    SteeringSums sums;
+    sums.separation = glm::vec3(horizontal_sum(sep_x), horizontal_sum(sep_y), horizontal_sum(sep_z));
+    sums.alignment = glm::vec3(horizontal_sum(ali_x), horizontal_sum(ali_y), horizontal_sum(ali_z));
+    sums.cohesion = glm::vec3(horizontal_sum(coh_x), horizontal_sum(coh_y), horizontal_sum(coh_z));
+    sums.close_count = close_count;
+    sums.visible_count = visible_count;
+    return sums;
+}
+
+STEERING_TARGET_AVX2
+inline float horizontal_sum(__m256 v) {
+    return horizontal_sum(_mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1)));
+}
+
+STEERING_TARGET_AVX2
+SteeringSums accumulate_avx2(const SteeringQuery& q, const NeighborBlock& block) {
+    const __m256 px = _mm256_set1_ps(q.position.x);
+    const __m256 py = _mm256_set1_ps(q.position.y);
+    const __m256 pz = _mm256_set1_ps(q.position.z);
+    const __m256 dir_x = _mm256_set1_ps(q.cone.direction.x);
+    const __m256 dir_y = _mm256_set1_ps(q.cone.direction.y);
+    const __m256 dir_z = _mm256_set1_ps(q.cone.direction.z);
+    const __m256 close_sq = _mm256_set1_ps(q.close_sq);
+    const __m256 visible_sq = _mm256_set1_ps(q.visible_sq);
+    const __m256 cos_half_sq = _mm256_set1_ps(q.cone.cos_half_sq);
+    const __m256 one = _mm256_set1_ps(1.f);
+    const __m256 predator_weight = _mm256_set1_ps(q.predator_weight);
+    const __m256 separate = _mm256_castsi256_ps(_mm256_set1_epi32(q.separate ? -1 : 0));
+    const __m256 wide = _mm256_castsi256_ps(_mm256_set1_epi32(q.cone.wide ? -1 : 0));
+    const __m256 full_circle = _mm256_castsi256_ps(_mm256_set1_epi32(q.cone.full_circle ? -1 : 0));
+    const __m256 zero = _mm256_setzero_ps();
+
+    __m256 sep_x = zero, sep_y = zero, sep_z = zero;
+    __m256 ali_x = zero, ali_y = zero, ali_z = zero;
+    __m256 coh_x = zero, coh_y = zero, coh_z = zero;
+    int close_count = 0;
+    int visible_count = 0;
+
+    for (size_t i = 0; i < block.count; i += 8) {
+        __m256 ox = _mm256_loadu_ps(&block.x[i]);
+        __m256 oy = _mm256_loadu_ps(&block.y[i]);
+        __m256 oz = _mm256_loadu_ps(&block.z[i]);
+        __m256 dx = _mm256_sub_ps(ox, px);
+        __m256 dy = _mm256_sub_ps(oy, py);
+        __m256 dz = _mm256_sub_ps(oz, pz);
+        __m256 dist_sq = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)), _mm256_mul_ps(dz, dz));
+
+        __m256 close = _mm256_and_ps(_mm256_cmp_ps(dist_sq, close_sq, _CMP_LE_OQ), separate);
+        __m256 facing = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dir_x, dx), _mm256_mul_ps(dir_y, dy)), _mm256_mul_ps(dir_z, dz));
+        __m256 facing_sq = _mm256_mul_ps(facing, facing);
+        __m256 edge_sq = _mm256_mul_ps(cos_half_sq, dist_sq);
+        __m256 in_front = _mm256_cmp_ps(facing, zero, _CMP_NLT_UQ);
+        __m256 in_wide = _mm256_or_ps(in_front, _mm256_cmp_ps(facing_sq, edge_sq, _CMP_NGT_UQ));
+        __m256 in_narrow = _mm256_and_ps(in_front, _mm256_cmp_ps(facing_sq, edge_sq, _CMP_NLT_UQ));
+        __m256 in_view = _mm256_or_ps(_mm256_blendv_ps(in_narrow, in_wide, wide), full_circle);
+        __m256 visible = _mm256_and_ps(_mm256_cmp_ps(dist_sq, visible_sq, _CMP_LE_OQ), in_view);
+
+        __m256 weight = _mm256_add_ps(one, _mm256_mul_ps(_mm256_loadu_ps(&block.predator[i]), predator_weight));
+        __m256 neg_weight = _mm256_blendv_ps(zero, _mm256_sub_ps(zero, weight), close);
+        sep_x = _mm256_add_ps(sep_x, _mm256_mul_ps(dx, neg_weight));
+        sep_y = _mm256_add_ps(sep_y, _mm256_mul_ps(dy, neg_weight));
+        sep_z = _mm256_add_ps(sep_z, _mm256_mul_ps(dz, neg_weight));
+
+        ali_x = _mm256_add_ps(ali_x, _mm256_blendv_ps(zero, _mm256_loadu_ps(&block.vx[i]), visible));
+        ali_y = _mm256_add_ps(ali_y, _mm256_blendv_ps(zero, _mm256_loadu_ps(&block.vy[i]), visible));
+        ali_z = _mm256_add_ps(ali_z, _mm256_blendv_ps(zero, _mm256_loadu_ps(&block.vz[i]), visible));
+        coh_x = _mm256_add_ps(coh_x, _mm256_blendv_ps(zero, ox, visible));
+        coh_y = _mm256_add_ps(coh_y, _mm256_blendv_ps(zero, oy, visible));
+        coh_z = _mm256_add_ps(coh_z, _mm256_blendv_ps(zero, oz, visible));
+
+        close_count += popcount(_mm256_movemask_ps(close));
+        visible_count += popcount(_mm256_movemask_ps(visible));
+    }
+
+    SteeringSums sums;
+    sums.separation = glm::vec3(horizontal_sum(sep_x), horizontal_sum(sep_y), horizontal_sum(sep_z));
+    sums.alignment = glm::vec3(horizontal_sum(ali_x), horizontal_sum(ali_y), horizontal_sum(ali_z));
+    sums.cohesion = glm::vec3(horizontal_sum(coh_x), horizontal_sum(coh_y), horizontal_sum(coh_z));
+    sums.close_count = close_count;
+    sums.visible_count = visible_count;
+    return sums;
+}
+
+bool cpu_has_avx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif // STEERING_KERNEL_X86
+} // namespace
+
+bool steering_kernel_supported(SteeringKernel kernel) {
+    switch (kernel) {
+        case SteeringKernel::NeighborLists:
+        case SteeringKernel::Scalar:
+            return true;
+#ifdef STEERING_KERNEL_X86
+        case SteeringKernel::SSE:
+            return true;
+        case SteeringKernel::AVX2: {
+            static const bool has_avx2 = cpu_has_avx2();
+            return has_avx2;
+        }
+#endif
+        default:
+            return false;
+    }
+}
+
+SteeringKernel best_steering_kernel() {
+    if (steering_kernel_supported(SteeringKernel::AVX2)) return SteeringKernel::AVX2;
+    if (steering_kernel_supported(SteeringKernel::SSE)) return SteeringKernel::SSE;
+    return SteeringKernel::Scalar;
+}
+
+const char* steering_kernel_name(SteeringKernel kernel) {
+    switch (kernel) {
+        case SteeringKernel::NeighborLists: return "neighbor lists";
+        case SteeringKernel::Scalar: return "scalar";
+        case SteeringKernel::SSE: return "sse";
+        case SteeringKernel::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+void NeighborBlock::load(const FlockState& state, const uint32_t* boids, size_t num_boids) {
+    count = num_boids;
+    size_t padded = (count + kBlockWidth - 1) / kBlockWidth * kBlockWidth;
+    x.resize(padded); y.resize(padded); z.resize(padded);
+    vx.resize(padded); vy.resize(padded); vz.resize(padded);
+    predator.resize(padded);
+
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t boid = boids[i];
+        x[i] = state.x[boid]; y[i] = state.y[boid]; z[i] = state.z[boid];
+        vx[i] = state.vx[boid]; vy[i] = state.vy[boid]; vz[i] = state.vz[boid];
+        predator[i] = state.is_predator(boid) ? 1.f : 0.f;
+    }
+    // Padding sits infinitely far away, so every mask rejects it.
+    const float far = std::numeric_limits<float>::max();
+    for (size_t i = count; i < padded; ++i) {
+        x[i] = far; y[i] = far; z[i] = far;
+        vx[i] = 0.f; vy[i] = 0.f; vz[i] = 0.f;
+        predator[i] = 0.f;
+    }
+}
+
+SteeringQuery::SteeringQuery(const glm::vec3& position, const glm::vec3& velocity,
+                             float close_radius, float visible_radius, float view_angle,
+                             float predator_weight, bool separate)
+    : position(position), cone(velocity, view_angle),
+      close_sq(close_radius * close_radius), visible_sq(visible_radius * visible_radius),
+      predator_weight(predator_weight), separate(separate) {}
+
+SteeringSums accumulate_steering(const SteeringQuery& query, const NeighborBlock& block, SteeringKernel kernel) {
+#ifdef STEERING_KERNEL_X86
+    if (kernel == SteeringKernel::AVX2 && steering_kernel_supported(SteeringKernel::AVX2)) {
+        return accumulate_avx2(query, block);
+    }
+    if (kernel == SteeringKernel::SSE) {
+        return accumulate_sse(query, block);
+    }
+#endif
+    return accumulate_scalar(query, block);
+}
+} // namespace GLOO
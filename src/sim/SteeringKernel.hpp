@@ -0,0 +1,83 @@
+#ifndef STEERING_KERNEL_HPP_
+#define STEERING_KERNEL_HPP_
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include "FlockState.hpp"
+#include "ViewCone.hpp"
+
+namespace GLOO{
+// How FlockSimulation accumulates the steering sums of a boid.
+enum class SteeringKernel {
+    // Classify into close/visible index lists, then sum over the lists.
+    NeighborLists,
+    // Masked accumulation over SoA candidate blocks, one lane at a time,
+    Scalar,
+    // four lanes at a time,
+    SSE,
+    // or eight lanes at a time.
+    AVX2
+};
+
+// Widest vector kernel this CPU can run. Not always the fastest: see
+// FlockSimulation::steering_kernel_.
+SteeringKernel best_steering_kernel();
+bool steering_kernel_supported(SteeringKernel kernel);
+const char* steering_kernel_name(SteeringKernel kernel);
+
+// Candidate neighbors copied out of a FlockState into SoA arrays, padded
+// with far-away dummies to a multiple of kBlockWidth so the vector kernels
+// never need a remainder loop.
+struct NeighborBlock {
+    static const size_t kBlockWidth = 8;
+
+    std::vector<float> x, y, z;
+    std::vector<float> vx, vy, vz;
+    // 1 for predators, 0 for prey.
+    std::vector<float> predator;
+    size_t count = 0;
+
+    void load(const FlockState& state, const uint32_t* boids, size_t num_boids);
+    void load(const FlockState& state, const std::vector<uint32_t>& boids) {
+        load(state, boids.data(), boids.size());
+    };
+};
+
+// One boid's thresholds. Every kernel tests the view cone exactly as
+// ViewCone::contains does, on the same floats, so they pick the same
+// visible neighbors as NeighborGather, including the boid itself.
+struct SteeringQuery {
+    SteeringQuery(const glm::vec3& position, const glm::vec3& velocity,
+                  float close_radius, float visible_radius, float view_angle,
+                  float predator_weight, bool separate);
+
+    glm::vec3 position;
+    ViewCone cone;
+    float close_sq;
+    float visible_sq;
+    // Extra separation weight for close predators.
+    float predator_weight;
+    // False for predators, which are not pushed apart by their neighbors.
+    bool separate;
+};
+
+// Sums over the candidates of a block:
+//   separation += (position - other) * (1 + predator * predator_weight)
+//                 for close candidates,
+//   alignment += other velocity and cohesion += other position
+//                 for visible candidates.
+struct SteeringSums {
+    glm::vec3 separation{0.f};
+    glm::vec3 alignment{0.f};
+    glm::vec3 cohesion{0.f};
+    int close_count = 0;
+    int visible_count = 0;
+};
+
+// kernel must not be NeighborLists; unsupported kernels fall back to Scalar.
+SteeringSums accumulate_steering(const SteeringQuery& query, const NeighborBlock& block, SteeringKernel kernel);
+} // namespace GLOO
+
+#endif // STEERING_KERNEL_HPP_
@@ -0,0 +1,107 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+
+namespace GLOO{
+
+ThreadPool::ThreadPool(unsigned num_threads) {
+    start_workers(std::max(num_threads, 1u) - 1);
+}
+
+ThreadPool::~ThreadPool() {
+    stop_workers();
+}
+
+void ThreadPool::set_thread_count(unsigned num_threads) {
+    num_threads = std::max(num_threads, 1u);
+    if (num_threads == get_thread_count()) return;
+    stop_workers();
+    start_workers(num_threads - 1);
+}
+
+void ThreadPool::start_workers(unsigned num_workers) {
+    // Workers start out having seen the current generation; reading it from
+    // inside the new thread could miss a job posted before the thread runs.
+    unsigned generation;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = false;
+        generation = generation_;
+    }
+    workers_.reserve(num_workers);
+    for (unsigned i = 0; i < num_workers; ++i) {
+        workers_.emplace_back(&ThreadPool::worker_loop, this, generation);
+    }
+}
+
+void ThreadPool::stop_workers() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    start_cv_.notify_all();
+    for (std::thread& worker : workers_) {
+        worker.join();
+    }
+    workers_.clear();
+}
+
+void ThreadPool::worker_loop(unsigned seen_generation) {
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_cv_.wait(lock, [&] { return stop_ || generation_ != seen_generation; });
+            if (stop_) return;
+            seen_generation = generation_;
+        }
+        run_chunks();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--busy_ == 0) {
+                done_cv_.notify_one();
+            }
+        }
+    }
+}
+
+void ThreadPool::run_chunks() {
+    size_t num_chunks = (count_ + chunk_size_ - 1) / chunk_size_;
+    for (;;) {
+        size_t chunk = next_chunk_.fetch_add(1);
+        if (chunk >= num_chunks) return;
+        size_t begin = chunk * chunk_size_;
+        size_t end = std::min(begin + chunk_size_, count_);
+        (*job_)(begin, end);
+    }
+}
+
+void ThreadPool::parallel_for(size_t count, size_t chunk_size, const std::function<void(size_t, size_t)>& fn) {
+    if (count == 0) return;
+    chunk_size = std::max<size_t>(chunk_size, 1);
+
+    // Not worth waking anyone up for a single chunk.
+    if (workers_.empty() || count <= chunk_size) {
+        for (size_t begin = 0; begin < count; begin += chunk_size) {
+            fn(begin, std::min(begin + chunk_size, count));
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = &fn;
+        count_ = count;
+        chunk_size_ = chunk_size;
+        next_chunk_ = 0;
+        busy_ = static_cast<unsigned>(workers_.size());
+        ++generation_;
+    }
+    start_cv_.notify_all();
+    run_chunks();
+
+    // Every worker checks in once per generation, so after this no worker
+    // can still be holding a pointer to fn.
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [&] { return busy_ == 0; });
+    job_ = nullptr;
+}
+} // namespace GLOO
@@ -0,0 +1,57 @@
+#ifndef THREAD_POOL_HPP_
+#define THREAD_POOL_HPP_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <cstddef>
+
+namespace GLOO{
+// Persistent pool of worker threads for data-parallel loops. Workers sleep on
+// a condition variable between jobs, so a parallel_for costs a wake-up rather
+// than thread creation. The calling thread always takes part in the work.
+class ThreadPool {
+    public:
+        // num_threads counts the calling thread, so 1 means no workers.
+        explicit ThreadPool(unsigned num_threads = 1);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        unsigned get_thread_count() const {
+            return static_cast<unsigned>(workers_.size()) + 1;
+        };
+        // Joins the current workers and starts num_threads - 1 new ones.
+        void set_thread_count(unsigned num_threads);
+
+        // Splits [0, count) into chunks of chunk_size and calls fn(begin, end)
+        // on each, returning once every chunk has finished.
+        void parallel_for(size_t count, size_t chunk_size, const std::function<void(size_t, size_t)>& fn);
+
+    private:
+        void start_workers(unsigned num_workers);
+        void stop_workers();
+        void worker_loop(unsigned seen_generation);
+        void run_chunks();
+
+        std::vector<std::thread> workers_;
+        std::mutex mutex_;
+        std::condition_variable start_cv_;
+        std::condition_variable done_cv_;
+
+        // Current job, guarded by mutex_ except for next_chunk_.
+        const std::function<void(size_t, size_t)>* job_ = nullptr;
+        size_t count_ = 0;
+        size_t chunk_size_ = 1;
+        std::atomic<size_t> next_chunk_{0};
+        unsigned generation_ = 0;
+        unsigned busy_ = 0;
+        bool stop_ = false;
+};
+} // namespace GLOO
+
+#endif // THREAD_POOL_HPP_
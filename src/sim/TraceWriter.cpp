@@ -0,0 +1,133 @@
+#include "TraceWriter.hpp"
+
+#ifdef BOIDS_PROFILING
+
+#include <algorithm>
+
+namespace GLOO{
+
+TraceWriter& TraceWriter::instance() {
+    static TraceWriter writer;
+    return writer;
+}
+
+TraceWriter::~TraceWriter() {
+    stop();
+}
+
+bool TraceWriter::start(const std::string& path) {
+    if (is_recording()) return false;
+    file_ = std::fopen(path.c_str(), "w");
+    if (file_ == nullptr) return false;
+    std::fputs("[", file_);
+    first_event_ = true;
+    origin_ = std::chrono::steady_clock::now();
+
+    // Throw away whatever was pushed after the last recording stopped.
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        for (const std::unique_ptr<Ring>& ring : rings_) {
+            ring->tail.store(ring->head.load(std::memory_order_acquire), std::memory_order_release);
+            ring->dropped.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    stop_flush_ = false;
+    flusher_ = std::thread(&TraceWriter::flush_loop, this);
+    recording_.store(true, std::memory_order_release);
+    return true;
+}
+
+void TraceWriter::stop() {
+    if (!is_recording()) return;
+    recording_.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(flush_mutex_);
+        stop_flush_ = true;
+    }
+    flush_cv_.notify_one();
+    flusher_.join();
+    drain();
+    std::fputs("\n]\n", file_);
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+uint64_t TraceWriter::get_dropped() const {
+    std::lock_guard<std::mutex> lock(rings_mutex_);
+    uint64_t dropped = 0;
+    for (const std::unique_ptr<Ring>& ring : rings_) {
+        dropped += ring->dropped.load(std::memory_order_relaxed);
+    }
+    return dropped;
+}
+
+void TraceWriter::push(const char* name, TimePoint time, char phase) {
+    Ring& ring = thread_ring();
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= kRingCapacity) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ring.events[head % kRingCapacity] = Event{name, time, phase};
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+TraceWriter::Ring& TraceWriter::thread_ring() {
+    thread_local Ring* ring = nullptr;
+    if (ring == nullptr) {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        rings_.emplace_back(new Ring());
+        ring = rings_.back().get();
+        ring->tid = static_cast<int>(rings_.size());
+    }
+    return *ring;
+}
+
+void TraceWriter::flush_loop() {
+    std::unique_lock<std::mutex> lock(flush_mutex_);
+    while (!stop_flush_) {
+        flush_cv_.wait_for(lock, std::chrono::milliseconds(kFlushIntervalMs));
+        if (stop_flush_) break;
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+void TraceWriter::drain() {
+    std::vector<Ring*> rings;
+    {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        for (const std::unique_ptr<Ring>& ring : rings_) {
+            rings.push_back(ring.get());
+        }
+    }
+
+    out_.clear();
+    char line[160];
+    for (Ring* ring : rings) {
+        uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail) {
+            const Event& event = ring->events[tail % kRingCapacity];
+            double us = std::chrono::duration<double, std::micro>(event.time - origin_).count();
+            // Instant events need a scope; "t" draws them on their thread.
+            int length = std::snprintf(line, sizeof(line),
+                "%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d%s}",
+                first_event_ ? "" : ",", event.name, event.phase, us, ring->tid,
+                event.phase == 'i' ? ",\"s\":\"t\"" : "");
+            if (length > 0) {
+                out_.append(line, std::min(static_cast<size_t>(length), sizeof(line) - 1));
+            }
+            first_event_ = false;
+        }
+        ring->tail.store(tail, std::memory_order_release);
+    }
+    if (!out_.empty()) {
+        std::fwrite(out_.data(), 1, out_.size(), file_);
+    }
+}
+} // namespace GLOO
+
+#endif // BOIDS_PROFILING
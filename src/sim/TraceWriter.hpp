@@ -0,0 +1,106 @@
+#ifndef TRACE_WRITER_HPP_
+#define TRACE_WRITER_HPP_
+
+// Records begin/end events of every PROFILE_SCOPE, on any thread, into a
+// Chrome trace_event JSON file (open it in chrome://tracing or Perfetto).
+// Each thread appends to its own ring buffer without locks; a background
+// thread drains the rings into the file every kFlushIntervalMs, so the
+// threads being traced never wait on I/O. A ring that fills up between
+// flushes drops events rather than block, and the drops are counted.
+//
+// Event names are stored by pointer and must outlive the recording; string
+// literals, as PROFILE_SCOPE takes, do. Part of the profiler build
+// (BOIDS_PROFILING).
+
+#ifdef BOIDS_PROFILING
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace GLOO{
+class TraceWriter {
+    public:
+        using TimePoint = std::chrono::steady_clock::time_point;
+
+        static TraceWriter& instance();
+
+        // Starts writing to path, replacing it; false if it cannot be opened
+        // or a recording is already running.
+        bool start(const std::string& path);
+        // Flushes what is left and closes the file.
+        void stop();
+        bool is_recording() const {
+            return recording_.load(std::memory_order_relaxed);
+        };
+        // Events lost to full rings in this recording.
+        uint64_t get_dropped() const;
+
+        void begin(const char* name, TimePoint time) {
+            push(name, time, 'B');
+        };
+        void end(const char* name, TimePoint time) {
+            push(name, time, 'E');
+        };
+        // A zero-length marker, e.g. for a slow step.
+        void instant(const char* name) {
+            push(name, std::chrono::steady_clock::now(), 'i');
+        };
+
+    private:
+        static const size_t kRingCapacity = 1 << 14;
+        static const int kFlushIntervalMs = 50;
+
+        struct Event {
+            const char* name;
+            TimePoint time;
+            char phase;
+        };
+
+        // Single producer (its thread), single consumer (the flush thread):
+        // the producer only advances head, the consumer only tail.
+        struct Ring {
+            int tid;
+            std::vector<Event> events = std::vector<Event>(kRingCapacity);
+            std::atomic<uint64_t> head{0};
+            std::atomic<uint64_t> tail{0};
+            std::atomic<uint64_t> dropped{0};
+        };
+
+        TraceWriter() {}
+        ~TraceWriter();
+
+        void push(const char* name, TimePoint time, char phase);
+        Ring& thread_ring();
+        void flush_loop();
+        // Writes out every ring's pending events; only the flush thread, or
+        // stop() once it has joined, calls this.
+        void drain();
+
+        std::atomic<bool> recording_{false};
+        TimePoint origin_;
+        FILE* file_ = nullptr;
+        bool first_event_ = true;
+        std::string out_;
+
+        // Rings are registered once per thread and live as long as the writer.
+        mutable std::mutex rings_mutex_;
+        std::vector<std::unique_ptr<Ring>> rings_;
+
+        std::thread flusher_;
+        std::mutex flush_mutex_;
+        std::condition_variable flush_cv_;
+        bool stop_flush_ = false;
+};
+} // namespace GLOO
+
+#endif // BOIDS_PROFILING
+
+#endif // TRACE_WRITER_HPP_
@@ -0,0 +1,286 @@
+#include "Trajectory.hpp"
+#include <cstring>
+#include <algorithm>
+
+#if defined(_WIN32)
+#define TRAJECTORY_MAP_WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#define TRAJECTORY_MAP_POSIX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace GLOO{
+
+namespace {
+const char kMagic[8] = {'B', 'O', 'I', 'D', 'T', 'R', 'J', '\0'};
+const uint32_t kVersion = 1;
+
+size_t predator_words(size_t boid_count) {
+    return (boid_count + 63) / 64;
+}
+
+size_t frame_size(size_t boid_count, size_t param_count) {
+    size_t bytes = sizeof(uint64_t) * (1 + predator_words(boid_count)) +
+                   sizeof(float) * (param_count + 6 * boid_count);
+    return (bytes + 63) / 64 * 64;
+}
+
+// Maps path read-only and sets size. Where the platform has no mapping the
+// whole file is read into a heap buffer instead; unmap_file() frees either.
+const unsigned char* map_file(const std::string& path, size_t& size) {
+#if defined(TRAJECTORY_MAP_WIN32)
+    HANDLE file = ::CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+    LARGE_INTEGER file_size;
+    if (!::GetFileSizeEx(file, &file_size) || file_size.QuadPart <= 0) {
+        ::CloseHandle(file);
+        return nullptr;
+    }
+    size = static_cast<size_t>(file_size.QuadPart);
+    HANDLE mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping != nullptr ? ::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    // The view keeps the file alive on its own.
+    if (mapping != nullptr) ::CloseHandle(mapping);
+    ::CloseHandle(file);
+    return static_cast<const unsigned char*>(view);
+#elif defined(TRAJECTORY_MAP_POSIX)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return nullptr;
+    }
+    size = static_cast<size_t>(info.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping keeps the file alive on its own.
+    ::close(fd);
+    return mapping != MAP_FAILED ? static_cast<const unsigned char*>(mapping) : nullptr;
+#else
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) return nullptr;
+    long file_size = -1;
+    if (std::fseek(file, 0, SEEK_END) == 0) {
+        file_size = std::ftell(file);
+    }
+    unsigned char* data = nullptr;
+    if (file_size > 0 && std::fseek(file, 0, SEEK_SET) == 0) {
+        size = static_cast<size_t>(file_size);
+        data = new unsigned char[size];
+        if (std::fread(data, 1, size, file) != size) {
+            delete[] data;
+            data = nullptr;
+        }
+    }
+    std::fclose(file);
+    return data;
+#endif
+}
+
+void unmap_file(const unsigned char* data, size_t size) {
+#if defined(TRAJECTORY_MAP_WIN32)
+    (void)size;
+    ::UnmapViewOfFile(data);
+#elif defined(TRAJECTORY_MAP_POSIX)
+    ::munmap(const_cast<unsigned char*>(data), size);
+#else
+    (void)size;
+    delete[] data;
+#endif
+}
+} // namespace
+
+TrajectoryWriter::~TrajectoryWriter() {
+    close();
+}
+
+bool TrajectoryWriter::open(const std::string& path, size_t boid_count, size_t param_count, float time_step_size) {
+    close();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (file_ == nullptr) return false;
+    failed_ = false;
+
+    std::memset(&header_, 0, sizeof(header_));
+    std::memcpy(header_.magic, kMagic, sizeof(kMagic));
+    header_.version = kVersion;
+    header_.boid_count = static_cast<uint32_t>(boid_count);
+    header_.param_count = static_cast<uint32_t>(param_count);
+    header_.time_step_size = time_step_size;
+    header_.frame_size = frame_size(boid_count, param_count);
+    chunk_capacity_ = std::max<size_t>(kChunkBytes / header_.frame_size, 1);
+    chunk_.assign(chunk_capacity_ * header_.frame_size, 0);
+    chunk_frames_ = 0;
+
+    if (std::fwrite(&header_, sizeof(header_), 1, file_) != 1) {
+        failed_ = true;
+    }
+    return !failed_;
+}
+
+bool TrajectoryWriter::append(uint64_t step, const FlockState& state, const std::vector<float>& params) {
+    if (file_ == nullptr || failed_) return false;
+    size_t n = header_.boid_count;
+    if (state.size() != n || params.size() != header_.param_count) return false;
+
+    unsigned char* frame = chunk_.data() + chunk_frames_ * header_.frame_size;
+    uint64_t* step_out = reinterpret_cast<uint64_t*>(frame);
+    uint64_t* bits = step_out + 1;
+    float* params_out = reinterpret_cast<float*>(bits + predator_words(n));
+    float* x = params_out + header_.param_count;
+    float* y = x + n;
+    float* z = y + n;
+    float* vx = z + n;
+    float* vy = vx + n;
+    float* vz = vy + n;
+
+    *step_out = step;
+    std::fill(bits, bits + predator_words(n), uint64_t(0));
+    std::copy(params.begin(), params.end(), params_out);
+    // Scatter into id order so a boid keeps its slot across frames.
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t id = state.id[i];
+        x[id] = state.x[i];
+        y[id] = state.y[i];
+        z[id] = state.z[i];
+        vx[id] = state.vx[i];
+        vy[id] = state.vy[i];
+        vz[id] = state.vz[i];
+        if (state.is_predator(i)) {
+            bits[id >> 6] |= uint64_t(1) << (id & 63);
+        }
+    }
+
+    ++header_.frame_count;
+    if (++chunk_frames_ == chunk_capacity_) {
+        return flush_chunk();
+    }
+    return true;
+}
+
+bool TrajectoryWriter::flush_chunk() {
+    if (chunk_frames_ > 0 &&
+        std::fwrite(chunk_.data(), header_.frame_size, chunk_frames_, file_) != chunk_frames_) {
+        failed_ = true;
+    }
+    chunk_frames_ = 0;
+    return !failed_;
+}
+
+bool TrajectoryWriter::close() {
+    if (file_ == nullptr) return false;
+    flush_chunk();
+
+    // Frames are back to back after the header.
+    std::vector<uint64_t> index(header_.frame_count);
+    for (size_t i = 0; i < index.size(); ++i) {
+        index[i] = sizeof(TrajectoryHeader) + i * header_.frame_size;
+    }
+    header_.index_offset = sizeof(TrajectoryHeader) + header_.frame_count * header_.frame_size;
+    if (!index.empty() && std::fwrite(index.data(), sizeof(uint64_t), index.size(), file_) != index.size()) {
+        failed_ = true;
+    }
+    if (std::fseek(file_, 0, SEEK_SET) != 0 || std::fwrite(&header_, sizeof(header_), 1, file_) != 1) {
+        failed_ = true;
+    }
+    if (std::fclose(file_) != 0) {
+        failed_ = true;
+    }
+    file_ = nullptr;
+    chunk_.clear();
+    chunk_.shrink_to_fit();
+    return !failed_;
+}
+
+TrajectoryReader::~TrajectoryReader() {
+    close();
+}
+
+bool TrajectoryReader::open(const std::string& path) {
+    close();
+    data_ = map_file(path, file_size_);
+    if (data_ == nullptr) {
+        file_size_ = 0;
+        return false;
+    }
+    if (file_size_ < sizeof(TrajectoryHeader)) {
+        close();
+        return false;
+    }
+
+    std::memcpy(&header_, data_, sizeof(header_));
+    if (std::memcmp(header_.magic, kMagic, sizeof(kMagic)) != 0 || header_.version != kVersion ||
+        header_.frame_size != frame_size(header_.boid_count, header_.param_count)) {
+        close();
+        return false;
+    }
+
+    size_t frames_end = file_size_;
+    // Divides rather than multiplies so a corrupt frame_count cannot wrap.
+    if (header_.index_offset >= sizeof(TrajectoryHeader) && header_.index_offset <= file_size_ &&
+        header_.index_offset % sizeof(uint64_t) == 0 &&
+        header_.frame_count <= (file_size_ - header_.index_offset) / sizeof(uint64_t)) {
+        index_ = reinterpret_cast<const uint64_t*>(data_ + header_.index_offset);
+        frames_end = header_.index_offset;
+        frame_count_ = header_.frame_count;
+        // frame() trusts the entries, so every one must be a whole frame
+        // slot before the index.
+        for (size_t i = 0; i < frame_count_; ++i) {
+            uint64_t entry = index_[i];
+            if (entry < sizeof(TrajectoryHeader) || (entry - sizeof(TrajectoryHeader)) % header_.frame_size != 0 ||
+                entry > frames_end || frames_end - entry < header_.frame_size) {
+                close();
+                return false;
+            }
+        }
+    } else {
+        // Writer did not finish: use every complete frame.
+        frame_count_ = (file_size_ - sizeof(TrajectoryHeader)) / header_.frame_size;
+    }
+    if (sizeof(TrajectoryHeader) + frame_count_ * header_.frame_size > frames_end) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void TrajectoryReader::close() {
+    if (data_ != nullptr) {
+        unmap_file(data_, file_size_);
+    }
+    data_ = nullptr;
+    index_ = nullptr;
+    file_size_ = 0;
+    frame_count_ = 0;
+}
+
+TrajectoryFrame TrajectoryReader::frame(size_t frame) const {
+    size_t offset = index_ != nullptr ? static_cast<size_t>(index_[frame])
+                                      : sizeof(TrajectoryHeader) + frame * header_.frame_size;
+    const unsigned char* base = data_ + offset;
+    size_t n = header_.boid_count;
+
+    TrajectoryFrame out;
+    out.boid_count = n;
+    std::memcpy(&out.step, base, sizeof(uint64_t));
+    out.predator_bits = reinterpret_cast<const uint64_t*>(base) + 1;
+    out.params = reinterpret_cast<const float*>(out.predator_bits + predator_words(n));
+    out.x = out.params + header_.param_count;
+    out.y = out.x + n;
+    out.z = out.y + n;
+    out.vx = out.z + n;
+    out.vy = out.vx + n;
+    out.vz = out.vy + n;
+    return out;
+}
+} // namespace GLOO
@@ -0,0 +1,149 @@
+#ifndef TRAJECTORY_HPP_
+#define TRAJECTORY_HPP_
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+#include <glm/glm.hpp>
+#include "FlockState.hpp"
+
+namespace GLOO{
+// Binary recording of a flock run, one frame per step.
+//
+// File layout: a TrajectoryHeader, then fixed-size frames written about
+// kChunkBytes at a time, then the frame index (frame_count uint64
+// file offsets). Each frame is
+//   uint64 step
+//   uint64 predator_bits[(boid_count + 63) / 64]
+//   float  params[param_count]
+//   float  x[boid_count], y, z, vx, vy, vz
+// padded to a multiple of 64 bytes. Boids are stored in FlockState::id
+// order, so boid i is the same boid in every frame whatever reordering the
+// simulation did. A file whose writer never closed has index_offset 0; the
+// reader then counts the complete frames after the header.
+struct TrajectoryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t boid_count;
+    uint32_t param_count;
+    float time_step_size;
+    uint64_t frame_count;
+    uint64_t frame_size;
+    uint64_t index_offset;
+    uint8_t reserved[16];
+};
+static_assert(sizeof(TrajectoryHeader) == 64, "trajectory header must stay 64 bytes");
+
+// One frame of a trajectory, pointing into the reader's mapping.
+struct TrajectoryFrame {
+    uint64_t step = 0;
+    size_t boid_count = 0;
+    const uint64_t* predator_bits = nullptr;
+    const float* params = nullptr;
+    const float *x = nullptr, *y = nullptr, *z = nullptr;
+    const float *vx = nullptr, *vy = nullptr, *vz = nullptr;
+
+    size_t size() const {
+        return boid_count;
+    };
+    glm::vec3 position(size_t i) const {
+        return glm::vec3(x[i], y[i], z[i]);
+    };
+    glm::vec3 velocity(size_t i) const {
+        return glm::vec3(vx[i], vy[i], vz[i]);
+    };
+    bool is_predator(size_t i) const {
+        return (predator_bits[i >> 6] >> (i & 63)) & 1u;
+    };
+};
+
+// Appends frames to a trajectory file. Frames are buffered a chunk at a time
+// and the index is written by close().
+class TrajectoryWriter {
+    public:
+        // Target chunk size. A chunk always holds at least one frame, so with
+        // a million boids (24 MB frames) every frame is written on its own.
+        static const size_t kChunkBytes = size_t(8) << 20;
+
+        TrajectoryWriter() {}
+        ~TrajectoryWriter();
+
+        TrajectoryWriter(const TrajectoryWriter&) = delete;
+        TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+        // Creates (or replaces) path for frames of boid_count boids.
+        bool open(const std::string& path, size_t boid_count, size_t param_count, float time_step_size);
+        // Adds the state after a step; false on a write error or if the boid
+        // or parameter count differs from open().
+        bool append(uint64_t step, const FlockState& state, const std::vector<float>& params);
+        // Writes the pending chunk and the index. False if anything failed
+        // since open().
+        bool close();
+
+        bool is_open() const {
+            return file_ != nullptr;
+        };
+        uint64_t get_frame_count() const {
+            return header_.frame_count;
+        };
+
+    private:
+        bool flush_chunk();
+
+        FILE* file_ = nullptr;
+        bool failed_ = false;
+        TrajectoryHeader header_;
+        std::vector<unsigned char> chunk_;
+        size_t chunk_frames_ = 0;
+        size_t chunk_capacity_ = 0;
+};
+
+// Memory-maps a trajectory file, so opening costs nothing however long the
+// run was, frame() is O(1) and the OS pages frames in as they are read.
+// Uses mmap on POSIX and MapViewOfFile on Windows; elsewhere the file is
+// read into memory whole.
+class TrajectoryReader {
+    public:
+        TrajectoryReader() {}
+        ~TrajectoryReader();
+
+        TrajectoryReader(const TrajectoryReader&) = delete;
+        TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+
+        // False if the file cannot be mapped, is not a trajectory or has an
+        // index entry pointing outside its frames.
+        bool open(const std::string& path);
+        void close();
+
+        bool is_open() const {
+            return data_ != nullptr;
+        };
+        size_t get_frame_count() const {
+            return frame_count_;
+        };
+        size_t get_boid_count() const {
+            return header_.boid_count;
+        };
+        size_t get_param_count() const {
+            return header_.param_count;
+        };
+        float get_time_step_size() const {
+            return header_.time_step_size;
+        };
+
+        // frame must be below get_frame_count().
+        TrajectoryFrame frame(size_t frame) const;
+
+    private:
+        const unsigned char* data_ = nullptr;
+        size_t file_size_ = 0;
+        TrajectoryHeader header_;
+        size_t frame_count_ = 0;
+        // Index entries inside the mapping, or null for an unclosed file.
+        const uint64_t* index_ = nullptr;
+};
+} // namespace GLOO
+
+#endif // TRAJECTORY_HPP_
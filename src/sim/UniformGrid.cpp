@@ -0,0 +1,145 @@
+#include "UniformGrid.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+namespace GLOO{
+
+void UniformGrid::build(glm::vec3 lower_bound, glm::vec3 upper_bound, float cell_size, const FlockState& state) {
+    state_ = &state;
+    size_t n = state.size();
+    lower_bound_ = lower_bound;
+    upper_bound_ = upper_bound;
+
+    glm::vec3 extent = upper_bound_ - lower_bound_;
+    float max_extent = std::max(extent.x, std::max(extent.y, extent.z));
+    cell_size_ = std::max(cell_size, max_extent / kMaxCellsPerAxis);
+    dims_ = glm::max(glm::ivec3(glm::ceil(extent / cell_size_)), glm::ivec3(1));
+
+    size_t num_cells = static_cast<size_t>(dims_.x) * dims_.y * dims_.z;
+    cell_start_.assign(num_cells + 1, 0);
+    cell_of_.resize(n);
+
+    // Count boids per cell.
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t cell = static_cast<uint32_t>(cell_index(cell_coords(state.position(i))));
+        cell_of_[i] = cell;
+        cell_start_[cell]++;
+    }
+
+    // Inclusive prefix sum leaves the end offset of each cell in cell_start_.
+    for (size_t c = 1; c <= num_cells; ++c) {
+        cell_start_[c] += cell_start_[c - 1];
+    }
+
+    // Scatter back to front, decrementing each end offset down to the cell's
+    // start. Walking in reverse keeps boids in input order within a cell.
+    sorted_boids_.resize(n);
+    sorted_positions_.resize(n);
+    for (size_t i = n; i-- > 0; ) {
+        uint32_t slot = --cell_start_[cell_of_[i]];
+        sorted_boids_[slot] = static_cast<uint32_t>(i);
+        sorted_positions_[slot] = state.position(i);
+    }
+}
+
+glm::ivec3 UniformGrid::cell_coords(const glm::vec3& pos) const {
+    glm::ivec3 coords = glm::ivec3(glm::floor((pos - lower_bound_) / cell_size_));
+    return glm::clamp(coords, glm::ivec3(0), dims_ - 1);
+}
+
+float UniformGrid::cell_distance_sq(const glm::ivec3& coords, const glm::vec3& pos) const {
+    glm::vec3 lower = lower_bound_ + glm::vec3(coords) * cell_size_;
+    glm::vec3 upper = lower + cell_size_;
+    // Border cells also hold the boids clamped in from outside the bounds.
+    for (int axis = 0; axis < 3; ++axis) {
+        if (coords[axis] == 0) lower[axis] = -FLT_MAX;
+        if (coords[axis] == dims_[axis] - 1) upper[axis] = FLT_MAX;
+    }
+    glm::vec3 to_cell = glm::clamp(pos, lower, upper) - pos;
+    return glm::dot(to_cell, to_cell);
+}
+
+void UniformGrid::query(uint32_t boid, float radius, float view_angle, std::vector<uint32_t>& found) const {
+    if (sorted_boids_.empty()) return;
+
+    glm::vec3 pos = state_->position(boid);
+    glm::ivec3 lo = cell_coords(pos - glm::vec3(radius));
+    glm::ivec3 hi = cell_coords(pos + glm::vec3(radius));
+    float radius_sq = radius * radius;
+    ViewCone cone(state_->velocity(boid), view_angle);
+
+    for (int z = lo.z; z <= hi.z; ++z) {
+        for (int y = lo.y; y <= hi.y; ++y) {
+            // Cells along x are contiguous in the flat array, so scan the whole row at once.
+            size_t row_begin = cell_start_[cell_index(glm::ivec3(lo.x, y, z))];
+            size_t row_end = cell_start_[cell_index(glm::ivec3(hi.x, y, z)) + 1];
+            for (size_t k = row_begin; k < row_end; ++k) {
+                glm::vec3 delta = sorted_positions_[k] - pos;
+                float dist_sq = glm::dot(delta, delta);
+                if (dist_sq <= radius_sq && cone.contains(delta)) {
+                    found.push_back(sorted_boids_[k]);
+                }
+            }
+        }
+    }
+}
+
+void UniformGrid::gather_impl(const NeighborGather& gather, std::vector<uint32_t>& close, std::vector<uint32_t>& visible) const {
+    if (sorted_boids_.empty()) return;
+
+    glm::ivec3 lo = cell_coords(gather.position - glm::vec3(gather.radius));
+    glm::ivec3 hi = cell_coords(gather.position + glm::vec3(gather.radius));
+
+    for (int z = lo.z; z <= hi.z; ++z) {
+        for (int y = lo.y; y <= hi.y; ++y) {
+            size_t row_begin = cell_start_[cell_index(glm::ivec3(lo.x, y, z))];
+            size_t row_end = cell_start_[cell_index(glm::ivec3(hi.x, y, z)) + 1];
+            for (size_t k = row_begin; k < row_end; ++k) {
+                gather.classify(sorted_boids_[k], sorted_positions_[k], close, visible);
+            }
+        }
+    }
+}
+
+void UniformGrid::candidates_impl(const glm::vec3& position, float radius, std::vector<uint32_t>& found) const {
+    if (sorted_boids_.empty()) return;
+
+    glm::ivec3 lo = cell_coords(position - glm::vec3(radius));
+    glm::ivec3 hi = cell_coords(position + glm::vec3(radius));
+
+    for (int z = lo.z; z <= hi.z; ++z) {
+        for (int y = lo.y; y <= hi.y; ++y) {
+            size_t row_begin = cell_start_[cell_index(glm::ivec3(lo.x, y, z))];
+            size_t row_end = cell_start_[cell_index(glm::ivec3(hi.x, y, z)) + 1];
+            found.insert(found.end(), sorted_boids_.begin() + row_begin, sorted_boids_.begin() + row_end);
+        }
+    }
+}
+
+void UniformGrid::nearest_impl(const glm::vec3& position, const ViewCone& cone, NearestNeighbors& nearest) const {
+    if (sorted_boids_.empty()) return;
+
+    float radius = std::sqrt(nearest.bound_sq());
+    glm::ivec3 lo = cell_coords(position - glm::vec3(radius));
+    glm::ivec3 hi = cell_coords(position + glm::vec3(radius));
+
+    for (int z = lo.z; z <= hi.z; ++z) {
+        for (int y = lo.y; y <= hi.y; ++y) {
+            for (int x = lo.x; x <= hi.x; ++x) {
+                // Skip cells beyond the current k-th distance.
+                if (cell_distance_sq(glm::ivec3(x, y, z), position) > nearest.bound_sq()) continue;
+
+                size_t cell = cell_index(glm::ivec3(x, y, z));
+                for (size_t k = cell_start_[cell]; k < cell_start_[cell + 1]; ++k) {
+                    glm::vec3 delta = sorted_positions_[k] - position;
+                    float dist_sq = glm::dot(delta, delta);
+                    if (dist_sq <= nearest.bound_sq() && cone.contains(delta)) {
+                        nearest.offer(sorted_boids_[k], dist_sq);
+                    }
+                }
+            }
+        }
+    }
+}
+} // namespace GLOO
@@ -0,0 +1,63 @@
+#ifndef UNIFORM_GRID_HPP_
+#define UNIFORM_GRID_HPP_
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "FlockState.hpp"
+#include "SpatialIndex.hpp"
+
+namespace GLOO{
+// Uniform grid over [lower_bound, upper_bound] built with a counting sort:
+// boids are bucketed by cell into one flat array and cell_start_ stores the
+// prefix sums, so a rebuild is O(n + cells) with no per-cell allocations.
+// Boids outside the bounds are clamped into the border cells.
+class UniformGrid : public SpatialIndex {
+public:
+    UniformGrid() {}
+
+    // Rebuilds the grid in place; buffers are reused between frames.
+    void build(glm::vec3 lower_bound, glm::vec3 upper_bound, float cell_size, const FlockState& state);
+
+    void query(uint32_t boid, float radius, float view_angle, std::vector<uint32_t>& found) const override;
+
+    glm::ivec3 get_dims() const {
+        return dims_;
+    };
+
+protected:
+    glm::vec3 position_of(uint32_t boid) const override {
+        return state_->position(boid);
+    };
+    glm::vec3 velocity_of(uint32_t boid) const override {
+        return state_->velocity(boid);
+    };
+    void gather_impl(const NeighborGather& gather, std::vector<uint32_t>& close, std::vector<uint32_t>& visible) const override;
+    void candidates_impl(const glm::vec3& position, float radius, std::vector<uint32_t>& found) const override;
+    void nearest_impl(const glm::vec3& position, const ViewCone& cone, NearestNeighbors& nearest) const override;
+
+private:
+    glm::ivec3 cell_coords(const glm::vec3& pos) const;
+    // Squared distance from pos to the cell's box.
+    float cell_distance_sq(const glm::ivec3& coords, const glm::vec3& pos) const;
+    size_t cell_index(const glm::ivec3& coords) const {
+        return (static_cast<size_t>(coords.z) * dims_.y + coords.y) * dims_.x + coords.x;
+    };
+
+    // Upper limit on cells per axis so tiny visible ranges cannot blow up memory.
+    static const int kMaxCellsPerAxis = 128;
+
+    const FlockState* state_ = nullptr;
+    glm::vec3 lower_bound_{0.f};
+    glm::vec3 upper_bound_{0.f};
+    float cell_size_ = 1.f;
+    glm::ivec3 dims_{0};
+
+    std::vector<uint32_t> cell_of_;          // cell index per input boid
+    std::vector<uint32_t> cell_start_;       // size cells + 1
+    std::vector<uint32_t> sorted_boids_;     // boid indices grouped by cell
+    std::vector<glm::vec3> sorted_positions_; // positions in the same order
+};
+} // namespace GLOO
+
+#endif // UNIFORM_GRID_HPP_
@@ -0,0 +1,63 @@
+#include "VerletList.hpp"
+#include <algorithm>
+
+namespace GLOO{
+
+bool VerletList::needs_rebuild(const FlockState& state, float radius, float skin) const {
+    if (!valid_ || state.size() != build_positions_.size() || radius != radius_ || skin != skin_) {
+        return true;
+    }
+    float limit_sq = 0.25f * skin * skin;
+    for (size_t i = 0; i < state.size(); ++i) {
+        glm::vec3 moved = state.position(i) - build_positions_[i];
+        if (glm::dot(moved, moved) > limit_sq) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void VerletList::build(const SpatialIndex& index, const FlockState& state, float radius, float skin, ThreadPool& pool) {
+    size_t n = state.size();
+    radius_ = radius;
+    skin_ = skin;
+    build_positions_.resize(n);
+    counts_.resize(n);
+    chunk_neighbors_.resize((n + kChunkSize - 1) / kChunkSize);
+
+    float reach = radius + skin;
+    float reach_sq = reach * reach;
+    pool.parallel_for(n, kChunkSize, [&](size_t begin, size_t end) {
+        std::vector<uint32_t>& out = chunk_neighbors_[begin / kChunkSize];
+        out.clear();
+        std::vector<uint32_t> candidates;
+        for (size_t i = begin; i < end; ++i) {
+            glm::vec3 position = state.position(i);
+            build_positions_[i] = position;
+            index.candidates(static_cast<uint32_t>(i), reach, candidates);
+            size_t before = out.size();
+            for (uint32_t other : candidates) {
+                glm::vec3 delta = state.position(other) - position;
+                if (glm::dot(delta, delta) <= reach_sq) {
+                    out.push_back(other);
+                }
+            }
+            counts_[i] = static_cast<uint32_t>(out.size() - before);
+        }
+    });
+
+    // Chunks hold consecutive boids, so concatenating them in order gives
+    // the CSR array.
+    offsets_.resize(n + 1);
+    offsets_[0] = 0;
+    for (size_t i = 0; i < n; ++i) {
+        offsets_[i + 1] = offsets_[i] + counts_[i];
+    }
+    neighbors_.resize(offsets_[n]);
+    for (size_t c = 0; c < chunk_neighbors_.size(); ++c) {
+        const std::vector<uint32_t>& chunk = chunk_neighbors_[c];
+        std::copy(chunk.begin(), chunk.end(), neighbors_.begin() + offsets_[c * kChunkSize]);
+    }
+    valid_ = true;
+}
+} // namespace GLOO
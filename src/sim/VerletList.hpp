@@ -0,0 +1,65 @@
+#ifndef VERLET_LIST_HPP_
+#define VERLET_LIST_HPP_
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include "FlockState.hpp"
+#include "SpatialIndex.hpp"
+#include "ThreadPool.hpp"
+
+namespace GLOO{
+// Per-boid neighbor candidates cached across steps, as in molecular
+// dynamics codes. build() stores every boid within radius + skin of each
+// boid in CSR form: neighbors_[offsets_[i], offsets_[i + 1]) are boid i's
+// candidates. Two boids approach each other by at most twice the largest
+// displacement since the build, so as long as no boid has moved more than
+// skin / 2 the lists still hold every boid within radius. The caller
+// filters them by exact distance and view cone each step.
+class VerletList {
+public:
+    VerletList() {}
+
+    // Whether the lists cannot serve state: nothing built yet, invalidate()
+    // called, the boid count, radius or skin changed, or some boid moved more
+    // than skin / 2 since the build.
+    bool needs_rebuild(const FlockState& state, float radius, float skin) const;
+
+    // Rebuilds the lists from index, which must be built on state, in
+    // parallel chunks on pool.
+    void build(const SpatialIndex& index, const FlockState& state, float radius, float skin, ThreadPool& pool);
+
+    // Forces a rebuild, e.g. after the state was reordered.
+    void invalidate() {
+        valid_ = false;
+    };
+
+    const uint32_t* neighbors(size_t boid) const {
+        return neighbors_.data() + offsets_[boid];
+    };
+    size_t neighbor_count(size_t boid) const {
+        return offsets_[boid + 1] - offsets_[boid];
+    };
+    // Entries over all lists.
+    size_t size() const {
+        return neighbors_.size();
+    };
+
+private:
+    // Boids per parallel_for chunk in build().
+    static const size_t kChunkSize = 256;
+
+    bool valid_ = false;
+    float radius_ = 0.f;
+    float skin_ = 0.f;
+    // Positions at the last build, to measure displacement against.
+    std::vector<glm::vec3> build_positions_;
+    std::vector<uint32_t> offsets_;
+    std::vector<uint32_t> neighbors_;
+    // Per-chunk lists and counts that build() stitches together.
+    std::vector<std::vector<uint32_t>> chunk_neighbors_;
+    std::vector<uint32_t> counts_;
+};
+} // namespace GLOO
+
+#endif // VERLET_LIST_HPP_
@@ -0,0 +1,46 @@
+#ifndef VIEW_CONE_HPP_
+#define VIEW_CONE_HPP_
+
+#include <cmath>
+#include <glm/glm.hpp>
+
+namespace GLOO{
+// A boid's field of view, precomputed once per query. The view angle is the
+// full opening angle of the cone around the velocity; 6.28 or more means all
+// directions.
+//
+// contains(delta) is the old acos(dot(dir, normalize(delta))) <= angle / 2
+// test rewritten as dot(dir, delta) >= cos(angle / 2) * |delta|. Both sides
+// are squared to avoid the square root, so the sign of dot(dir, delta) has to
+// be checked separately: for half angles up to 90 degrees the boid must be in
+// front, above 90 degrees anything in front is inside. Comparisons are
+// written so NaNs (the boid itself, a zero velocity) pass, as they did with
+// acos.
+struct ViewCone {
+    ViewCone(const glm::vec3& velocity, float view_angle)
+        : direction(glm::normalize(velocity)), full_circle(view_angle >= 6.28f) {
+        float cos_half = std::cos(view_angle / 2.0f);
+        wide = cos_half < 0.f;
+        cos_half_sq = cos_half * cos_half;
+    }
+
+    bool contains(const glm::vec3& delta) const {
+        if (full_circle) return true;
+        float facing = glm::dot(direction, delta);
+        float facing_sq = facing * facing;
+        float edge_sq = cos_half_sq * glm::dot(delta, delta);
+        if (wide) {
+            return !(facing < 0.f) || !(facing_sq > edge_sq);
+        }
+        return !(facing < 0.f) && !(facing_sq < edge_sq);
+    }
+
+    glm::vec3 direction;
+    float cos_half_sq;
+    // Half angle above 90 degrees.
+    bool wide;
+    bool full_circle;
+};
+} // namespace GLOO
+
+#endif // VIEW_CONE_HPP_
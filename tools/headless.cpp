@@ -0,0 +1,388 @@
+// Runs the flock simulation without a window, for parameter studies on
+// machines with no display or OpenGL.
+//
+// usage: boids_headless [options]
+//   --boids N           prey to spawn (default 4000)
+//   --predators N       predators to spawn (default 5)
+//   --steps N           steps to run (default 1000)
+//   --threads N         simulation threads (default: hardware concurrency)
+//   --seed N            seed for the spawn positions (default 42)
+//   --dt X              time step size (default 0.1)
+//   --index grid|quadtree|octree|incremental
+//   --rebuild-fraction X
+//                       incremental grid: rebuild when more than this
+//                       fraction of the boids changed cell (default 0.25)
+//   --kernel lists|scalar|sse|avx2
+//                       steering kernel (default: lists)
+//   --param NAME=VALUE  set one of params_, by name or index; repeatable
+//   --topological K     steer by the K nearest boids per range (default 0: all)
+//   --verlet SKIN       cache neighbor lists with this skin distance
+//   --reorder K         Morton-sort the state every K steps (default 0: off)
+//   --deterministic     sum neighbors in id order, so the result does not
+//                       depend on threads, index or reordering, and print
+//                       the final state's hash
+//   --dump PATH         write the final state as CSV
+//   --restore PATH      start from a snapshot instead of spawning; --dt and
+//                       --param given as well override its values; with
+//                       --index incremental or --verlet it needs
+//                       --deterministic to resume bit for bit
+//   --save PATH         write a snapshot of the final state
+//   --record PATH       write every step to a trajectory file
+//   --checkpoint PATH   write checkpoints from a background thread
+//   --checkpoint-interval N
+//                       steps between checkpoints (default 10)
+//   --checkpoint-mode quantized|lossless
+//   --profile           print per-step profiler zones (profiler builds only)
+//   --trace PATH        record a Chrome trace of the run (profiler builds only)
+//
+// Steps run back to back with no frame pacing, and the run ends with one
+// line of throughput numbers.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#include "sim/FlockSimulation.hpp"
+#include "sim/Profiler.hpp"
+#include "sim/Trajectory.hpp"
+#include "sim/Checkpoint.hpp"
+
+using namespace GLOO;
+
+namespace {
+// Same order as FlockSimulation::params_.
+const char* const kParamNames[] = {
+    "close_range", "visible_range", "visible_angle",
+    "alignment", "cohesion", "separation",
+    "max_speed", "max_force", "predator_avoidance"
+};
+const int kNumParams = sizeof(kParamNames) / sizeof(kParamNames[0]);
+
+void usage(const char* argv0) {
+    std::fprintf(stderr,
+        "usage: %s [--boids N] [--predators N] [--steps N] [--threads N]\n"
+        "          [--seed N] [--dt X] [--index grid|quadtree|octree|incremental]\n"
+        "          [--rebuild-fraction X] [--kernel lists|scalar|sse|avx2]\n"
+        "          [--param NAME=VALUE]... [--topological K] [--verlet SKIN]\n"
+        "          [--reorder K] [--dump PATH] [--restore PATH] [--save PATH]\n"
+        "          [--record PATH] [--profile] [--deterministic]\n"
+        "          [--checkpoint PATH] [--checkpoint-interval N]\n"
+        "          [--checkpoint-mode quantized|lossless]\n"
+        "          [--trace PATH]\n"
+        "params:", argv0);
+    for (int i = 0; i < kNumParams; ++i) {
+        std::fprintf(stderr, " %s", kParamNames[i]);
+    }
+    std::fprintf(stderr, "\n");
+}
+
+// Parses NAME=VALUE into params; NAME is a name from kParamNames or an index.
+bool set_param(const std::string& assignment, std::vector<float>& params) {
+    size_t eq = assignment.find('=');
+    if (eq == std::string::npos) return false;
+    std::string name = assignment.substr(0, eq);
+    float value = static_cast<float>(std::atof(assignment.c_str() + eq + 1));
+
+    int index = -1;
+    for (int i = 0; i < kNumParams; ++i) {
+        if (name == kParamNames[i]) index = i;
+    }
+    if (index < 0 && !name.empty() && std::all_of(name.begin(), name.end(), ::isdigit)) {
+        index = std::atoi(name.c_str());
+    }
+    if (index < 0 || index >= static_cast<int>(params.size())) return false;
+    params[index] = value;
+    return true;
+}
+
+bool dump_state(const FlockState& state, const char* path) {
+    FILE* file = std::fopen(path, "w");
+    if (file == nullptr) return false;
+    std::fprintf(file, "id,x,y,z,vx,vy,vz,predator\n");
+    for (size_t i = 0; i < state.size(); ++i) {
+        std::fprintf(file, "%u,%.9g,%.9g,%.9g,%.9g,%.9g,%.9g,%d\n", state.id[i],
+                     state.x[i], state.y[i], state.z[i],
+                     state.vx[i], state.vy[i], state.vz[i],
+                     state.is_predator(i) ? 1 : 0);
+    }
+    return std::fclose(file) == 0;
+}
+
+#ifdef BOIDS_PROFILING
+void print_profile() {
+    const Profiler& profiler = Profiler::instance();
+    std::printf("%-24s %10s %10s %10s\n", "zone", "min ms", "avg ms", "p99 ms");
+    for (size_t i = 0; i < profiler.zone_count(); ++i) {
+        const Profiler::Zone& zone = profiler.zone(i);
+        Profiler::ZoneStats stats = profiler.stats(i);
+        std::printf("%*s%-*s %10.3f %10.3f %10.3f\n", 2 * zone.depth, "", 24 - 2 * zone.depth,
+                    zone.name.c_str(), stats.min_ms, stats.avg_ms, stats.p99_ms);
+    }
+}
+#endif
+} // namespace
+
+int main(int argc, char** argv) {
+    int num_boids = 4000;
+    int num_predators = 5;
+    long steps = 1000;
+    unsigned threads = std::max(std::thread::hardware_concurrency(), 1u);
+    unsigned seed = 42;
+    float dt = 0.1f;
+    bool dt_given = false;
+    std::vector<std::string> param_assignments;
+    const char* dump_path = nullptr;
+    bool profile = false;
+    const char* trace_path = nullptr;
+    const char* record_path = nullptr;
+    const char* restore_path = nullptr;
+    const char* save_path = nullptr;
+    const char* checkpoint_path = nullptr;
+    int checkpoint_interval = 10;
+    CheckpointMode checkpoint_mode = CheckpointMode::Quantized;
+
+    FlockSimulation sim;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--profile") {
+            profile = true;
+            continue;
+        }
+        if (arg == "--deterministic") {
+            sim.deterministic_ = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+        if (arg == "--boids") {
+            num_boids = std::atoi(value);
+        } else if (arg == "--predators") {
+            num_predators = std::atoi(value);
+        } else if (arg == "--steps") {
+            steps = std::atol(value);
+        } else if (arg == "--threads") {
+            threads = static_cast<unsigned>(std::max(std::atoi(value), 1));
+        } else if (arg == "--seed") {
+            seed = static_cast<unsigned>(std::strtoul(value, nullptr, 10));
+        } else if (arg == "--dt") {
+            dt = static_cast<float>(std::atof(value));
+            dt_given = true;
+        } else if (arg == "--index") {
+            if (std::strcmp(value, "grid") == 0) {
+                sim.index_type_ = SpatialIndexType::UniformGrid;
+            } else if (std::strcmp(value, "quadtree") == 0) {
+                sim.index_type_ = SpatialIndexType::QuadTree;
+            } else if (std::strcmp(value, "octree") == 0) {
+                sim.index_type_ = SpatialIndexType::LinearOctree;
+            } else if (std::strcmp(value, "incremental") == 0) {
+                sim.index_type_ = SpatialIndexType::IncrementalGrid;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--rebuild-fraction") {
+            sim.rebuild_fraction_ = static_cast<float>(std::atof(value));
+        } else if (arg == "--kernel") {
+            if (std::strcmp(value, "lists") == 0) {
+                sim.steering_kernel_ = SteeringKernel::NeighborLists;
+            } else if (std::strcmp(value, "scalar") == 0) {
+                sim.steering_kernel_ = SteeringKernel::Scalar;
+            } else if (std::strcmp(value, "sse") == 0) {
+                sim.steering_kernel_ = SteeringKernel::SSE;
+            } else if (std::strcmp(value, "avx2") == 0) {
+                sim.steering_kernel_ = SteeringKernel::AVX2;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+            if (!steering_kernel_supported(sim.steering_kernel_)) {
+                std::fprintf(stderr, "%s kernel not supported on this CPU\n", value);
+                return 1;
+            }
+        } else if (arg == "--param") {
+            param_assignments.push_back(value);
+            if (!set_param(value, sim.params_)) {
+                std::fprintf(stderr, "bad --param %s\n", value);
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--topological") {
+            sim.topological_neighbors_ = std::max(std::atoi(value), 0);
+        } else if (arg == "--verlet") {
+            sim.verlet_lists_ = true;
+            sim.verlet_skin_ = std::max(static_cast<float>(std::atof(value)), 0.f);
+        } else if (arg == "--reorder") {
+            sim.reorder_interval_ = std::max(std::atoi(value), 0);
+        } else if (arg == "--dump") {
+            dump_path = value;
+        } else if (arg == "--restore") {
+            restore_path = value;
+        } else if (arg == "--save") {
+            save_path = value;
+        } else if (arg == "--record") {
+            record_path = value;
+        } else if (arg == "--checkpoint") {
+            checkpoint_path = value;
+        } else if (arg == "--checkpoint-interval") {
+            checkpoint_interval = std::max(std::atoi(value), 1);
+        } else if (arg == "--checkpoint-mode") {
+            if (std::strcmp(value, "quantized") == 0) {
+                checkpoint_mode = CheckpointMode::Quantized;
+            } else if (std::strcmp(value, "lossless") == 0) {
+                checkpoint_mode = CheckpointMode::Lossless;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (arg == "--trace") {
+            trace_path = value;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+#ifndef BOIDS_PROFILING
+    if (profile || trace_path != nullptr) {
+        std::fprintf(stderr, "--profile and --trace need a build with BOIDS_ENABLE_PROFILER\n");
+        return 1;
+    }
+#else
+    if (trace_path != nullptr && !TraceWriter::instance().start(trace_path)) {
+        std::fprintf(stderr, "could not write %s\n", trace_path);
+        return 1;
+    }
+#endif
+
+    sim.warn_slow_steps_ = false;
+    sim.set_time_step_size(dt);
+    sim.set_thread_count(threads);
+    sim.seed(seed);
+    if (restore_path != nullptr) {
+        FlockSnapshot snapshot;
+        auto r0 = std::chrono::steady_clock::now();
+        if (!read_snapshot(restore_path, snapshot)) {
+            std::fprintf(stderr, "could not read snapshot %s\n", restore_path);
+            return 1;
+        }
+        if (!sim.restore(std::move(snapshot))) {
+            std::fprintf(stderr, "--restore with --index incremental or --verlet needs --deterministic "
+                         "to continue the run bit for bit\n");
+            return 1;
+        }
+        std::printf("restored %zu boids at step %llu in %.2f ms\n", sim.size(),
+                    static_cast<unsigned long long>(sim.get_step_count()),
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - r0).count());
+        if (dt_given) {
+            sim.set_time_step_size(dt);
+        }
+        for (const std::string& assignment : param_assignments) {
+            set_param(assignment, sim.params_);
+        }
+    } else {
+        sim.spawn(num_boids, num_predators);
+    }
+
+    TrajectoryWriter recorder;
+    if (record_path != nullptr) {
+        if (!recorder.open(record_path, sim.size(), sim.params_.size(), sim.get_time_step_size())) {
+            std::fprintf(stderr, "could not write %s\n", record_path);
+            return 1;
+        }
+    }
+    CheckpointWriter checkpoints;
+    if (checkpoint_path != nullptr && !checkpoints.open(checkpoint_path, checkpoint_mode)) {
+        std::fprintf(stderr, "could not write %s\n", checkpoint_path);
+        return 1;
+    }
+    if (record_path != nullptr || checkpoint_path != nullptr) {
+        sim.on_step_ = [&](const FlockSimulation& s) {
+            if (recorder.is_open()) {
+                recorder.append(s.get_step_count(), s.get_state(), s.params_);
+            }
+            if (checkpoints.is_open() && s.get_step_count() % checkpoint_interval == 0) {
+                checkpoints.submit(s.get_step_count(), s.get_state(), s.params_, s.lower_bounds_, s.upper_bounds_);
+            }
+        };
+    }
+
+    size_t relocations = 0;
+    long rebuilds = 0;
+    long list_rebuilds = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (long i = 0; i < steps; ++i) {
+        sim.step();
+        PROFILE_FRAME();
+        relocations += sim.get_last_stats().index_relocations;
+        rebuilds += sim.get_last_stats().index_rebuilt;
+        list_rebuilds += sim.get_last_stats().neighbor_lists_rebuilt;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(t1 - t0).count();
+
+    std::printf("boids: %zu, steps: %ld, threads: %u, seconds: %.3f, "
+                "steps/s: %.2f, boid-steps/s: %.0f\n",
+                sim.size(), steps, sim.get_thread_count(), seconds,
+                steps / seconds, sim.size() * steps / seconds);
+    if (sim.verlet_lists_) {
+        std::printf("neighbor list rebuilds: %ld\n", list_rebuilds);
+    }
+    if (sim.index_type_ == SpatialIndexType::IncrementalGrid && steps > 0) {
+        std::printf("relocations/step: %.1f, full rebuilds: %ld\n",
+                    static_cast<double>(relocations) / steps, rebuilds);
+    }
+    if (sim.deterministic_) {
+        std::printf("state hash: %016llx\n", static_cast<unsigned long long>(hash_state(sim.get_state())));
+    }
+
+#ifdef BOIDS_PROFILING
+    if (trace_path != nullptr) {
+        TraceWriter::instance().stop();
+        std::printf("trace events dropped: %llu\n",
+                    static_cast<unsigned long long>(TraceWriter::instance().get_dropped()));
+    }
+    if (profile) {
+        print_profile();
+    }
+#endif
+
+    if (record_path != nullptr && !recorder.close()) {
+        std::fprintf(stderr, "could not write %s\n", record_path);
+        return 1;
+    }
+    if (checkpoint_path != nullptr) {
+        size_t skipped = checkpoints.get_dropped();
+        if (!checkpoints.close()) {
+            std::fprintf(stderr, "could not write %s\n", checkpoint_path);
+            return 1;
+        }
+        std::printf("checkpoints: %zu written, %zu skipped, %.1f bytes/boid\n", checkpoints.get_written(), skipped,
+                    checkpoints.get_written() > 0
+                        ? static_cast<double>(checkpoints.get_bytes_written()) / checkpoints.get_written() / sim.size()
+                        : 0.0);
+    }
+
+    if (save_path != nullptr) {
+        FlockSnapshot snapshot;
+        sim.save(snapshot);
+        if (!write_snapshot(snapshot, save_path)) {
+            std::fprintf(stderr, "could not write %s\n", save_path);
+            return 1;
+        }
+    }
+
+    if (dump_path != nullptr && !dump_state(sim.get_state(), dump_path)) {
+        std::fprintf(stderr, "could not write %s\n", dump_path);
+        return 1;
+    }
+    return 0;
+}